@@ -1,4 +1,6 @@
 #include "aoc21/helpers.h"
+#include <array>
+#include <vector>
 
 /*
 --- Day 1: Sonar Sweep ---
@@ -45,45 +47,176 @@ In this example, there are 7 measurements that are larger than the previous meas
 How many measurements are larger than the previous measurement?
 */
 
-int main(int argc, char** argv) {
-  aoc::AutoTimer t;
-
-  auto f = aoc::open_argv_1(argc, argv);
-
-  int deeper_count = 0;
-  int last_depth = INT_MAX;
-  std::pair<int, int> edges;
-  const size_t window_size = 3;
-  size_t count = 0;
-
-  int last_running_sum = INT_MAX;
-  int deeper_running_sum_count = 0;
-  int running_sum = 0;
-
-  const auto calculate_depths = [&](int depth) {
-    deeper_count += (depth > last_depth);
-    last_depth = depth;
-
-    running_sum += depth;
-    if (count == 0) {
-      edges.first = depth;
+namespace {
+  // Depths deeper than the one before, singly and as sums over a sliding
+  // window of three. Adjacent windows share two depths, so a window is deeper
+  // exactly when its newest depth is deeper than the one it pushed out.
+  class Sweep {
+  private:
+    std::array<int, 3> last_{};
+    size_t count_ = 0;
+
+  public:
+    int deeper = 0;
+    int deeper_windows = 0;
+
+    constexpr void add(int depth) {
+      if (count_ >= 1) {
+        deeper += depth > last_[(count_ - 1) % 3];
+      }
+      if (count_ >= 3) {
+        deeper_windows += depth > last_[count_ % 3];
+      }
+      last_[count_ % 3] = depth;
+      count_++;
     }
-    count++;
+  };
 
-    if (count >= window_size) {
-      deeper_running_sum_count += (running_sum > last_running_sum);
-      last_running_sum = running_sum;
-      running_sum -= edges.first;
-      edges.first = edges.second;
+  constexpr std::string_view Sample = R"(199
+200
+208
+210
+200
+207
+240
+269
+260
+263)";
+
+  constexpr Sweep sweep(std::string_view input) {
+    Sweep s;
+    aoc::ct::for_each_line(input, [&s](std::string_view line) { s.add(aoc::ct::to_integer(line)); });
+    return s;
+  }
+
+  // Number of i in [lag, n) with d[i] > d[i - lag]. The vector variants
+  // leave the last few to the scalar one.
+  constexpr size_t count_deeper_scalar(const int* d, size_t n, size_t lag) {
+    size_t count = 0;
+    for (size_t i = lag; i < n; i++) {
+      count += d[i] > d[i - lag];
+    }
+    return count;
+  }
+
+#if defined(AOC_ISA_X86)
+  AOC_TARGET("sse4.2") size_t count_deeper_sse42(const int* d, size_t n, size_t lag) {
+    size_t count = 0;
+    size_t i = lag;
+    for (; i + 4 <= n; i += 4) {
+      const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i - lag));
+      count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, b))));
+    }
+    return count + count_deeper_scalar(d + i - lag, n - i + lag, lag);
+  }
+
+  AOC_TARGET("avx2") size_t count_deeper_avx2(const int* d, size_t n, size_t lag) {
+    size_t count = 0;
+    size_t i = lag;
+    for (; i + 8 <= n; i += 8) {
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+      const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i - lag));
+      count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b))));
+    }
+    return count + count_deeper_scalar(d + i - lag, n - i + lag, lag);
+  }
+
+  AOC_TARGET("avx512f") size_t count_deeper_avx512(const int* d, size_t n, size_t lag) {
+    size_t count = 0;
+    size_t i = lag;
+    for (; i + 16 <= n; i += 16) {
+      const __m512i a = _mm512_loadu_si512(d + i);
+      const __m512i b = _mm512_loadu_si512(d + i - lag);
+      count += __builtin_popcount(_mm512_cmpgt_epi32_mask(a, b));
+    }
+    return count + count_deeper_scalar(d + i - lag, n - i + lag, lag);
+  }
+
+  const aoc::isa::Kernel<size_t(const int*, size_t, size_t)> count_deeper{
+    count_deeper_scalar, count_deeper_sse42, count_deeper_avx2, count_deeper_avx512 };
+#else
+  const aoc::isa::Kernel<size_t(const int*, size_t, size_t)> count_deeper{ count_deeper_scalar };
+#endif
+
+  // Sweep over a block of depths at a time, the last three of each block
+  // kept in front of the next for the windows that straddle them. The
+  // sample goes through it at compile time too, in blocks small enough to
+  // carry, with the scalar kernel.
+  template<size_t Block>
+  class BlockSweep {
+  private:
+    using Count = size_t(const int*, size_t, size_t);
+
+    Count* count_;
+    std::array<int, Block + 3> depths_{};
+    size_t size_ = 0;
+    size_t carried_ = 0;
+
+  public:
+    int deeper = 0;
+    int deeper_windows = 0;
+
+    constexpr explicit BlockSweep(Count* count)
+      : count_(count)
+    { }
+
+    constexpr void add(int depth) {
+      depths_[size_++] = depth;
+      if (size_ == depths_.size()) {
+        flush();
+      }
     }
 
-    edges.second = depth;
+    // Counts what has been added so far
+    constexpr void flush() {
+      for (const size_t lag : { size_t(1), size_t(3) }) {
+        const size_t from = carried_ >= lag ? carried_ - lag : 0;
+        const int c = static_cast<int>(count_(depths_.data() + from, size_ - from, lag));
+        (lag == 1 ? deeper : deeper_windows) += c;
+      }
+      carried_ = std::min<size_t>(size_, 3);
+      for (size_t i = 0; i < carried_; i++) {
+        depths_[i] = depths_[size_ - carried_ + i];
+      }
+      size_ = carried_;
+    }
   };
 
-  aoc::parse_as_integers(f, calculate_depths);
+  template<size_t Block>
+  constexpr aoc::SampleAnswers block_sweep(std::string_view input) {
+    BlockSweep<Block> s(count_deeper_scalar);
+    aoc::ct::for_each_line(input, [&s](std::string_view line) { s.add(aoc::ct::to_integer(line)); });
+    s.flush();
+    return { s.deeper, s.deeper_windows };
+  }
+
+  constexpr aoc::SampleAnswers SampleSolution{ sweep(Sample).deeper, sweep(Sample).deeper_windows };
+  static_assert(SampleSolution == aoc::SampleAnswers(7, 5));
+  static_assert(block_sweep<1>(Sample) == SampleSolution);
+  static_assert(block_sweep<4>(Sample) == SampleSolution);
+  static_assert(block_sweep<4096>(Sample) == SampleSolution);
+};
+
+static int run(int argc, char** argv) {
+  aoc::AutoTimer t;
+  t.phase("solve");
+
+  // One pass in constant memory, so the report can be piped in as it is taken
+  auto f = aoc::stream_argv_1(argc, argv);
+
+  BlockSweep<4096> s(count_deeper.best());
+  f.on_idle([&s]() {
+    s.flush();
+    aoc::print_running(s.deeper, s.deeper_windows);
+  });
+  aoc::parse_as_integers(f, [&s](int depth) { s.add(depth); });
+  s.flush();
 
-  aoc::print_results(deeper_count, deeper_running_sum_count);
+  aoc::print_results(s.deeper, s.deeper_windows);
 
   return 0;
 }
 
+AOC_REGISTER_DAY(1, run);
+AOC_REGISTER_SAMPLE_ANSWERS(1, SampleSolution);
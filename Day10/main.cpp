@@ -1,89 +1,168 @@
 #include "aoc21/helpers.h"
-#include <stack>
+#include <array>
 #include <vector>
 
-int main(int argc, char** argv) {
-  aoc::AutoTimer t;
+namespace {
+  // Syntax error score of a corrupted line, or the completion score of an
+  // incomplete one; the other is 0
+  class LineScore {
+  public:
+    int64_t error = 0;
+    int64_t completion = 0;
+  };
 
-  auto f = aoc::open_argv_1(argc, argv);
+  constexpr int64_t error_score(char c) {
+    switch (c) {
+      case ')': return 3;
+      case ']': return 57;
+      case '}': return 1197;
+      case '>': return 25137;
+      default: return 0;
+    }
+  }
 
-  std::string line;
-  int64_t score = 0;
-  std::vector<int64_t> completion_scores;
-  while (aoc::getline(f, line)) {
-    std::stack<char> st;
-    bool valid = true;
-    size_t pos = 0;
-    while (valid && pos < line.size()) {
-      const auto c = line[pos];
-      switch (c) {
-        case '(':
-        case '[':
-        case '{':
-        case '<':
-          st.push(c);
-          break;
-        case ')':
-          valid = st.top() == '(';
-          if (valid) { st.pop(); }
-          else { score += 3; }
-          break;
-        case ']':
-          valid = st.top() == '[';
-          if (valid) { st.pop(); }
-          else { score += 57; }
-          break;
-        case '}':
-          valid = st.top() == '{';
-          if (valid) { st.pop(); }
-          else { score += 1197; }
-          break;
-        case '>':
-          valid = st.top() == '<';
-          if (valid) { st.pop(); }
-          else { score += 25137; }
-          break;
-        default:
-          throw std::runtime_error("Invalid character");
+  constexpr int64_t completion_score(char c) {
+    switch (c) {
+      case '(': return 1;
+      case '[': return 2;
+      case '{': return 3;
+      case '<': return 4;
+      default: return 0;
+    }
+  }
+
+  constexpr char opener(char c) {
+    switch (c) {
+      case ')': return '(';
+      case ']': return '[';
+      case '}': return '{';
+      case '>': return '<';
+      default: return 0;
+    }
+  }
+
+  // Openers still waiting for their closers, for the sample, which is scored
+  // at compile time where there is no std::vector. Input lines use one.
+  template<size_t Depth>
+  class FixedStack {
+  private:
+    std::array<char, Depth> open_{};
+    size_t size_ = 0;
+
+  public:
+    constexpr bool empty() const {
+      return size_ == 0;
+    }
+
+    constexpr char back() const {
+      return open_[size_ - 1];
+    }
+
+    constexpr void push_back(char c) {
+      if (size_ == Depth) {
+        throw std::runtime_error("Line nested too deeply");
+      }
+      open_[size_++] = c;
+    }
+
+    constexpr void pop_back() {
+      size_--;
+    }
+
+    constexpr void clear() {
+      size_ = 0;
+    }
+  };
+
+  // open is scratch space, kept by the caller so lines can share it
+  template<typename Stack>
+  constexpr LineScore score_line(std::string_view line, Stack& open) {
+    open.clear();
+    for (const char c : line) {
+      if (completion_score(c)) {
+        open.push_back(c);
+      } else if (!opener(c)) {
+        throw std::runtime_error("Invalid character");
+      } else if (open.empty() || open.back() != opener(c)) {
+        return { error_score(c), 0 };
+      } else {
+        open.pop_back();
       }
-      pos++;
     }
 
-    if (valid) {
-      // auto complete
-      int64_t ac = 0;
-      while (!st.empty()) {
-        switch (st.top()) {
-        case '(':
-          ac *= 5;
-          ac += 1;
-          break;
-        case '[':
-          ac *= 5;
-          ac += 2;
-          break;
-        case '{':
-          ac *= 5;
-          ac += 3;
-          break;
-        case '<':
-          ac *= 5;
-          ac += 4;
-          break;
-        default:
-          throw std::runtime_error("Invalid character");
-        }
-        st.pop();
+    LineScore s;
+    while (!open.empty()) {
+      s.completion = s.completion * 5 + completion_score(open.back());
+      open.pop_back();
+    }
+    return s;
+  }
+
+  constexpr std::string_view Sample = R"([({(<(())[]>[[{[]{<()<>>
+[(()[<>])]({[<{<<[]>>(
+{([(<{}[<>[]}>{[]{[(<()>
+(((({<>}<{<{<>}{[]{[]{}
+[[<[([]))<([[{}[[()]]]
+[{[{({}]{}}([{[{{{}}([]
+{<[[]]>}<{[{[{[]{()[[[]
+[<(<(<(<{}))><([]([]()
+<{([([[(<>()){}]>(<<{{
+<{([{{}}[<[[[<>{}]]]>[]])";
+
+  constexpr aoc::SampleAnswers solve_sample() {
+    int64_t error = 0;
+    std::array<int64_t, 16> completions{};
+    size_t count = 0;
+    FixedStack<32> open;
+    aoc::ct::for_each_line(Sample, [&](std::string_view line) {
+      const auto s = score_line(line, open);
+      error += s.error;
+      if (s.completion) {
+        completions[count++] = s.completion;
       }
+    });
+    aoc::ct::sort(completions.begin(), completions.begin() + count);
+    return { error, completions[count / 2] };
+  }
 
-      completion_scores.push_back(ac);
+  constexpr aoc::SampleAnswers SampleSolution = solve_sample();
+  static_assert(SampleSolution == aoc::SampleAnswers(26397, 288957));
+};
+
+static int run(int argc, char** argv) {
+  aoc::AutoTimer t;
+  t.phase("solve");
+
+  // Lines are read from a stream one at a time. Part 2 needs the median, so
+  // one score per incomplete line is kept, but never the lines themselves.
+  auto f = aoc::stream_argv_1(argc, argv);
+
+  std::string_view line;
+  std::vector<char> open;
+  int64_t score = 0;
+  std::vector<int64_t> completion_scores;
+  const auto middle_score = [&]() -> int64_t {
+    if (completion_scores.empty()) {
+      return 0;
+    }
+    const auto m = completion_scores.begin() + completion_scores.size() / 2;
+    std::nth_element(completion_scores.begin(), m, completion_scores.end());
+    return *m;
+  };
+  f.on_idle([&]() { aoc::print_running(score, middle_score()); });
+
+  while (aoc::getline(f, line)) {
+    const auto s = score_line(line, open);
+    score += s.error;
+    if (s.completion) {
+      completion_scores.push_back(s.completion);
     }
   }
 
-  const auto m = completion_scores.begin() + completion_scores.size() / 2;
-  std::nth_element(completion_scores.begin(), m, completion_scores.end());
-  aoc::print_results(score, completion_scores[completion_scores.size() / 2]);
+  aoc::print_results(score, middle_score());
 
   return 0;
 }
 
+AOC_REGISTER_DAY(10, run);
+AOC_REGISTER_SAMPLE_ANSWERS(10, SampleSolution);
@@ -1,89 +1,112 @@
 #include "aoc21/helpers.h"
+#include "aoc21/automaton.h"
 #include <vector>
-#include <deque>
-#include <set>
 
 namespace {
-  using Row = std::vector<int>;
-  using Grid = std::vector<Row>;
-  using Point = std::pair<size_t, size_t>;
-  using FlashedQueue = std::deque<Point>;
-  using FlashedSet = std::set<Point>;
-
-  constexpr int DEAD_OCT = -1;
-
-  const FlashedSet Neighbors{
-    { -1, -1 }, 
-    { -1, 0 }, 
-    { -1, 1 }, 
-    { 0, -1 }, 
-    { 0, 1 }, 
-    { 1, -1 }, 
-    { 1, 0 }, 
-    { 1, 1 }, 
-  };
-
-  const auto step = [](Grid& grid) {
-    FlashedQueue q;
-    size_t flashed = 0;
-
-    for (size_t y = 0; y < grid.size(); y++) {
-      for (size_t x = 0; x < grid[0].size(); x++) {
-        if (grid[y][x] == DEAD_OCT) {
-          continue; // Padding point
-        }
-
-        assert( y > 0 && y < grid.size() - 1 );
-        assert( x > 0 && x < grid[y].size() - 1 );
+  // Energy levels as 4 bit planes, then the octopuses that flashed this
+  // step. Those that did not flash end a step at 9 or less, so a charge
+  // takes none of them past 10.
+  constexpr size_t EnergyBits = 4;
+  constexpr size_t Flashed = EnergyBits;
+  using Grid = aoc::automaton::Automaton<EnergyBits + 1>;
+  using Window = aoc::automaton::Window<EnergyBits + 1>;
+  using Out = std::array<uint64_t*, EnergyBits + 1>;
+  using Sum = aoc::automaton::Count<EnergyBits + 1>;
+
+  Sum energy(const Window& w, size_t i) {
+    Sum e{};
+    for (size_t b = 0; b < EnergyBits; b++) {
+      e[b] = w.at(b, 0, 0, i);
+    }
+    return e;
+  }
 
-        grid[y][x]++;
+  // The octopuses at 10 or more
+  uint64_t flashing(const Sum& e) {
+    return e[4] | (e[3] & (e[2] | e[1]));
+  }
 
-        if (grid[y][x] > 9) {
-          q.push_back(Point(y, x));
-          flashed++;
-          grid[y][x] = 0;
-        }
+  // Settles the last step, resetting those that flashed, then adds 1 to
+  // every level. Returns how many octopuses that makes flash.
+  const auto charge = [](const Window& w, const Out& out) {
+    uint64_t n = 0;
+    for (size_t i = 0; i < w.words(); i++) {
+      // Energy left from the last step plus one flash from each neighbour
+      // that flashed, at most 18
+      Sum e = aoc::automaton::add(energy(w, i), w.neighbours(Flashed, i));
+      const uint64_t flashed = w.at(Flashed, 0, 0, i);
+      uint64_t carry = ~uint64_t(0);
+      for (auto& b : e) {
+        b &= ~flashed;
+        const uint64_t c = b & carry;
+        b ^= carry;
+        carry = c;
+      }
+      for (size_t b = 0; b < EnergyBits; b++) {
+        out[b][i] = e[b];
       }
+      out[Flashed][i] = flashing(e);
+      n += __builtin_popcountll(out[Flashed][i] & w.valid(i));
     }
+    return n;
+  };
 
-    while (!q.empty()) {
-      auto fp = q.front(); q.pop_front();
-
-      for (const auto &n : Neighbors) {
-        size_t y = fp.first + n.first;
-        size_t x =  fp.second + n.second;
-
-        if (grid[y][x] == DEAD_OCT) {
-          continue; // Padding point
-        }
-        else if (grid[y][x] == 0) {
-          continue; // Already flashed this round
-        }
-
-        assert( y > 0 && y < grid.size() - 1 );
-        assert( x > 0 && x < grid[y].size() - 1 );
-
-        grid[y][x]++;
-
-        if (grid[y][x] > 9) {
-          q.push_back(Point(y, x));
-          flashed++;
-          grid[y][x] = 0;
+  // Flashes the octopuses that the flashes around them take to 10. The
+  // rows above and below keep still while a row is swept, so only the
+  // flashes either side are counted again as they spread along it.
+  // Returns how many flashed.
+  const auto cascade = [](const Window& w, const Out& out) {
+    uint64_t n = 0;
+    for (bool more = true; more;) {
+      more = false;
+      for (size_t i = 0; i < w.words(); i++) {
+        uint64_t flashed = w.at(Flashed, 0, 0, i);
+        const Sum e = aoc::automaton::add(energy(w, i), aoc::automaton::count8(
+          w.at(Flashed, -1, -1, i), w.at(Flashed, 0, -1, i), w.at(Flashed, 1, -1, i),
+          w.at(Flashed, -1, 1, i), w.at(Flashed, 0, 1, i), w.at(Flashed, 1, 1, i), 0, 0));
+        while (true) {
+          const uint64_t l = w.at(Flashed, -1, 0, i);
+          const uint64_t r = w.at(Flashed, 1, 0, i);
+          const uint64_t fresh = flashing(aoc::automaton::add(e, aoc::automaton::Count<2>{ l ^ r, l & r })) & ~flashed & w.valid(i);
+          if (!fresh) {
+            break;
+          }
+          flashed |= fresh;
+          out[Flashed][i] = flashed;
+          n += __builtin_popcountll(fresh);
+          // Only flashes at the ends of a word set off those in the words
+          // either side
+          more |= w.words() > 1 && (fresh & (uint64_t(1) | uint64_t(1) << 63));
         }
       }
     }
-
-    return flashed;
+    return n;
   };
 
+  // Octopuses that flashed in one step
+  uint64_t step(Grid& grid) {
+    return grid.step(charge) + grid.settle(cascade);
+  }
+
   void DisplayGrid(const Grid& g) {
-    for (const auto& r : g) {
-      for (const auto c : r) {
-        if (c == DEAD_OCT) {
-          continue;
+    for (size_t y = 0; y < g.height(); y++) {
+      for (size_t x = 0; x < g.width(); x++) {
+        int c = 0;
+        for (size_t b = 0; b < EnergyBits; b++) {
+          c |= g.plane(b).get(x, y) << b;
+        }
+        // Flashes have yet to be passed on to the rest
+        for (int dy = -1; dy <= 1; dy++) {
+          for (int dx = -1; dx <= 1; dx++) {
+            const size_t nx = x + dx;
+            const size_t ny = y + dy;
+            if ((dx || dy) && nx < g.width() && ny < g.height()) {
+              c += g.plane(Flashed).get(nx, ny);
+            }
+          }
         }
-        if (c == 0) {
-          std::cout << aoc::bold_on << c << aoc::bold_off << " ";
+        if (g.plane(Flashed).get(x, y)) {
+          std::cout << aoc::bold_on << 0 << aoc::bold_off << " ";
         } else {
           std::cout << c << " ";
         }
@@ -93,40 +116,40 @@ namespace {
   }
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  Grid grid;
-  std::string line;
-  std::size_t total_oct = 0;
+  std::vector<std::string_view> rows;
+  std::string_view line;
   while (aoc::getline(f, line)) {
-    Row r;
-    r.push_back(DEAD_OCT);
-    for (const char c : line) {
+    if (!rows.empty() && line.size() != rows[0].size()) {
+      throw std::runtime_error("Invalid input");
+    }
+    rows.push_back(line);
+  };
+
+  Grid grid(rows.empty() ? 0 : rows[0].size(), rows.size());
+  for (size_t y = 0; y < rows.size(); y++) {
+    for (size_t x = 0; x < rows[y].size(); x++) {
+      const char c = rows[y][x];
       if (!(c >= '0' && c <= '9')) {
         throw std::runtime_error("Invalid input");
       }
-      r.push_back(c - '0');
-      total_oct++;
-    }
-
-    r.push_back(DEAD_OCT);
-    assert(grid.empty() || r.size() == grid[0].size());
-    if (grid.empty()) {
-      Row pad(r.size(), DEAD_OCT);
-      grid.push_back(pad);
+      for (size_t b = 0; b < EnergyBits; b++) {
+        grid.plane(b).set(x, y, ((c - '0') >> b) & 1);
+      }
     }
-    grid.push_back(r);
-  };
-
-  Row pad(grid[0].size(), DEAD_OCT);
-  grid.push_back(pad);
+  }
+  f.close();
+  const std::size_t total_oct = grid.width() * grid.height();
 
   // 100 steps
   DEBUG(std::cout << "Total octupus: " << total_oct << std::endl);
 
+  t.phase("solve");
   size_t flash_count = 0;
   size_t first_syncd = SIZE_MAX;
   for (size_t i = 0; i < 100 || first_syncd == SIZE_MAX; i++) {
@@ -145,3 +168,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(11, run);
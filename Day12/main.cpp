@@ -1,115 +1,102 @@
 #include "aoc21/helpers.h"
+#include "aoc21/search.h"
 #include <vector>
-#include <map>
-#include <set>
-#include <deque>
-#include <memory>
 
 namespace {
-  using NodeList = std::vector<std::string>;
-  using Graph = std::map<std::string, NodeList, std::less<>>;
-  using VisitedSet = std::vector<std::string>;
-
   constexpr std::string_view Start("start");
   constexpr std::string_view End("end");
 
-  bool has_no_duplicates(VisitedSet v, const size_t max_small) {
-    std::sort(v.begin(), v.end());
-
-    VisitedSet::iterator it = v.begin();
-    size_t count = 0;
-    while (it != v.end() && count < max_small) {
-      it = std::adjacent_find(it, v.end());
-      if (it != v.end()) {
-        count++;
-        v.erase(it);
-        it = v.begin();
+  // Caves by index, in order of first mention
+  class Graph {
+  public:
+    aoc::FlatHashMap<std::string, uint8_t> index;
+    std::vector<std::vector<uint8_t>> edges;
+    std::vector<bool> small;
+
+    uint8_t cave(std::string_view name) {
+      const auto r = index.try_emplace(std::string(name), static_cast<uint8_t>(edges.size()));
+      if (r.second) {
+        if (edges.size() == MaxCaves) {
+          throw std::runtime_error("Too many caves");
+        }
+        edges.emplace_back();
+        small.push_back(std::islower(name[0]));
       }
+      return r.first->second;
     }
 
-    return count < max_small;
-  }
-
-  bool can_visit(const VisitedSet& v, std::string_view c, const size_t max_small) {
-    if (c == Start) {
-      return false;
-    }
-    if (!std::islower(c[0])) {
-      return true;
-    }
-
-    if (std::find(v.begin(), v.end(), c) == v.end()) {
-      return true;
-    }
-
-    return has_no_duplicates(v, max_small);
-  }
-
-  void walk_paths(const Graph& graph, VisitedSet& v, std::string_view c, size_t& paths, const size_t max_small) {
-    DEBUG_PRINT(c);
-    if (c == End) {
-      paths++;
-      return;
-    }
-
-    const auto cn = graph.find(c);
-    assert(cn != graph.end());
-
-    for (const auto& n: cn->second) {
-      if (!can_visit(v, n, max_small)) {
-        continue;
-      }
-
-      if (std::islower(n[0])) {
-        v.push_back(n);
-      }
-
-      walk_paths(graph, v, n, paths, max_small);
-
-      if (std::islower(n[0])) {
-        v.pop_back();
+    // The state packs the cave in the low byte and the small caves already
+    // seen in the bits above it, up to bit 62
+    static constexpr size_t MaxCaves = 55;
+  };
+
+  // A path so far: where it is, the small caves it has been through and, in
+  // the top bit, whether it has spent its one second visit. Paths with the
+  // same state have the same ways to finish, which count_paths() memoises.
+  using State = uint64_t;
+  constexpr State SpentTwice = State(1) << 63;
+
+  uint64_t count_paths(const Graph& graph, bool may_revisit) {
+    const uint8_t start = graph.index.at(Start);
+    const uint8_t end = graph.index.at(End);
+
+    aoc::FlatHashMap<State, uint64_t> memo;
+    const auto expand = [&](const State s, auto&& push) {
+      const uint8_t c = s & 0xff;
+      const State seen = s & ~SpentTwice & ~State(0xff);
+      for (const auto n : graph.edges[c]) {
+        if (n == start) {
+          continue;
+        }
+        State next = n | seen | (s & SpentTwice);
+        if (graph.small[n]) {
+          const State bit = State(1) << (n + 8);
+          if (seen & bit) {
+            if (!may_revisit || (s & SpentTwice)) {
+              continue;
+            }
+            next |= SpentTwice;
+          }
+          next |= bit;
+        }
+        push(next);
       }
-    }
+    };
+    const uint64_t paths = aoc::search::count_paths(State(start), memo, expand, [end](const State s) { return (s & 0xff) == end; });
+    aoc::note_footprint("memo", memo);
+    return paths;
   }
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
   Graph graph;
 
-  std::string s;
+  std::string_view s;
   while (aoc::getline(f, s)) {
-    const std::string_view sv(s);
-    const auto p = sv.find('-');
-    assert(p != std::string_view::npos);
-
-    auto n1 = std::string(sv.substr(0, p));
-    auto n2 = std::string(sv.substr(p + 1));
-
-    NodeList children{};
-    auto r = graph.emplace(std::pair<std::string, NodeList>(n1, children));
-    r.first->second.emplace_back(n2);
-    r = graph.emplace(std::pair<std::string, NodeList>(n2, children));
-    r.first->second.emplace_back(n1);
-  }
+    const auto p = s.find('-');
+    if (p == std::string_view::npos) {
+      throw std::runtime_error("Invalid input");
+    }
 
-  {
-    size_t paths = 0;
-    VisitedSet v{};
-    walk_paths(graph, v, Start, paths, 0);
-    aoc::print_result(1, paths);
+    const auto n1 = graph.cave(s.substr(0, p));
+    const auto n2 = graph.cave(s.substr(p + 1));
+    graph.edges[n1].push_back(n2);
+    graph.edges[n2].push_back(n1);
   }
+  f.close();
 
-  {
-    size_t paths = 0;
-    VisitedSet v{};
-    walk_paths(graph, v, Start, paths, 1);
-    aoc::print_result(2, paths);
-  }
+  t.phase("part1");
+  aoc::print_result(1, count_paths(graph, false));
+
+  t.phase("part2");
+  aoc::print_result(2, count_paths(graph, true));
 
   return 0;
 }
 
+AOC_REGISTER_DAY(12, run);
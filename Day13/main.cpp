@@ -3,8 +3,9 @@
 
 namespace {
 
-  using Row = std::vector<bool>;
-  using Sheet = std::vector<Row>;
+  using Point = std::pair<size_t, size_t>;
+  // One byte per dot; folds only ever shrink the part of it in use
+  using Sheet = aoc::Grid2D<uint8_t>;
 
   enum class Axis {
     X,
@@ -13,27 +14,19 @@ namespace {
 
   class Paper {
   public:
-    Paper()
+    explicit Paper(const std::vector<Point>& marks)
       : _width(0)
       , _height(0)
     {
-
-    }
-
-    void mark_point(size_t x, size_t y) {
-      if (y >= _height) {
-        _sheet.resize(y + 1);
-        _height = y + 1;
-      }
-
-      auto& r = _sheet[y];
-      
-      if (x >= r.size()) {
+      for (const auto& [x, y] : marks) {
         _width = std::max(x + 1, _width);
-        r.resize(_width, false);
+        _height = std::max(y + 1, _height);
       }
 
-      r[x] = true;
+      _sheet = Sheet(_width, _height);
+      for (const auto& [x, y] : marks) {
+        _sheet(x, y) = true;
+      }
     }
 
     void fold_along(Axis axis, size_t point) {
@@ -48,19 +41,17 @@ namespace {
       throw std::runtime_error("Invalid fold");
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const Paper p) {
+    friend std::ostream& operator<<(std::ostream& os, const Paper& p) {
       os << "+";
       for (size_t i = 0; i < p._width; i++) {
         os << "-";
       }
       os << "+" << std::endl;
-
       for (size_t h = 0; h < p._height; h++) {
         os << "|";
-        const auto& r = p._sheet[h];
+        const auto* r = p._sheet.row(h);
         for (size_t x = 0; x < p._width; x++) {
-          const auto set = x < r.size() && r[x];
-          if (set) {
+          if (r[x]) {
             os << "#";
           } else {
             os << " ";
@@ -73,20 +64,17 @@ namespace {
         os << "-";
       }
       os << "+" << std::endl;
-
       return os;
     }
 
     size_t count_marks() const {
       size_t marks = 0;
       for (size_t h = 0; h < _height; h++) {
-        const auto& r = _sheet[h];
+        const auto* r = _sheet.row(h);
         for (size_t x = 0; x < _width; x++) {
-          const auto set = x < r.size() && r[x];
-          marks += set;
+          marks += r[x];
         }
       }
-
       return marks;
     }
 
@@ -95,79 +83,45 @@ namespace {
       DEBUG_PRINT("Fold up @ " << point);
       // Every point below point gets folded up and marked in the top half
       // such that _sheet[point + 1] is transposed onto _sheet[point - 1], and so forth
-
       assert(point <= _height / 2);
-
-      const auto rows_to_transpose = _height - point;
-      for (size_t i = 1; i < rows_to_transpose; i++) {
-        if (i + point >= _height) {
-          break;
-        }
-        const auto& r = _sheet[i + point];
-        assert(static_cast<ssize_t>(point - i) >= 0);
-        auto& t_r = _sheet[point - i];
+      for (size_t i = 1; i + point < _height; i++) {
+        const auto* r = _sheet.row(i + point);
+        auto* t_r = _sheet.row(point - i);
         for (size_t x = 0; x < _width; x++) {
-          if (x >= t_r.size()) {
-            t_r.resize(_width, false);
-          }
-          if (x >= r.size()) {
-            break;
-          }
-
-          t_r[x] = (t_r[x] | r[x]);
+          t_r[x] |= r[x];
         }
       }
-
       _height = point;
     }
 
     void fold_across(size_t point) {
       DEBUG_PRINT("Fold across @ " << point);
-      // Every point below point gets folded across and marked in the left half
+      // Every point right of point gets folded across and marked in the left half
       // such that _sheet[*][point + 1] is transposed onto _sheet[*][point - 1], and so forth
-
       assert(point <= _width / 2);
-
-      const auto cols_to_transpose = _width - point;
-      for (auto &r : _sheet) {
-        for (size_t i = 1; i < cols_to_transpose; i++) {
-          const size_t t_x = point - i;
-          const size_t x = point + i;
-          if (x >= _width) {
-            break;
-          }
-          assert(static_cast<ssize_t>(point - i) >= 0);
-
-          if (t_x >= r.size()) {
-            r.resize(_width, false);
-          }
-
-          // No more to fold
-          if (x >= r.size()) {
-            break;
-          }
-
-          r[t_x] = (r[t_x] | r[x]);
+      for (size_t h = 0; h < _height; h++) {
+        auto* r = _sheet.row(h);
+        for (size_t i = 1; i + point < _width; i++) {
+          r[point - i] |= r[point + i];
         }
       }
-
       _width = point;
     }
 
   private:
     size_t _width;
     size_t _height;
-
     Sheet _sheet;
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  Paper s;
+  std::vector<Point> marks;
   std::string line;
   // Parse the points
   while (aoc::getline(f, line)) {
@@ -181,9 +135,11 @@ int main(int argc, char** argv) {
     const auto x = line.substr(0, p);
     const auto y = line.substr(p + 1);
 
-    s.mark_point(std::stoull(x), std::stoull(y));
+    marks.emplace_back(std::stoull(x), std::stoull(y));
   }
+  Paper s(marks);
 
+  t.phase("part1");
   size_t part1 = 0;
   do {
     const auto p = line.find('=');
@@ -212,6 +168,7 @@ int main(int argc, char** argv) {
 
     if (part1 == 0) {
       part1 = s.count_marks();
+      t.phase("part2");
     }
   } while (aoc::getline(f, line));
 
@@ -220,3 +177,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(13, run);
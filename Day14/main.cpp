@@ -1,107 +1,149 @@
 #include "aoc21/helpers.h"
 
 #include <array>
-#include <list>
-#include <map>
 
 namespace {
-  using PolymerPair = std::array<char, 2>;
-  using InsertionRules = std::map<PolymerPair, char>;
-  using Frequencies = std::map<char, size_t>;
-  using PolymerPairCounts = std::map<PolymerPair, size_t>;
-
-  const auto step = [](const PolymerPairCounts& pc, const InsertionRules& rules, Frequencies& f) {
-    PolymerPairCounts new_pairs;
-    for (const auto& [ k, v]: pc) {
-      if (!v) {
-        continue;
+  constexpr size_t Elements = 26;
+
+  // Counts of each pair of adjacent elements, which is all a step needs, and
+  // of each element. Elements are the letters A-Z, so both fit in flat arrays.
+  class Polymer {
+  private:
+    std::array<int64_t, Elements * Elements> pairs_{};
+    // Element inserted into each pair, plus 1; 0 for pairs without a rule
+    std::array<uint8_t, Elements * Elements> rules_{};
+    std::array<int64_t, Elements> counts_{};
+
+    static constexpr size_t element(char c) {
+      if (c < 'A' || c > 'Z') {
+        throw std::runtime_error("Invalid input");
       }
+      return c - 'A';
+    }
 
-      const auto r = rules.find(k);
-      if (r == rules.end()) {
-        continue;
+  public:
+    constexpr void set_template(std::string_view line) {
+      for (size_t i = 0; i < line.size(); i++) {
+        counts_[element(line[i])]++;
+        if (i > 0) {
+          pairs_[element(line[i - 1]) * Elements + element(line[i])]++;
+        }
       }
+    }
 
-      // account for new first pair
-      {
-        PolymerPair p{ k[0], r->second };
-        auto np = new_pairs.insert({ p, 0 });
-        np.first->second += v;
+    // Takes "CH -> B"
+    constexpr void add_rule(std::string_view line) {
+      if (line.size() != 7 || line.substr(2, 4) != " -> ") {
+        throw std::runtime_error("Invalid input");
       }
+      rules_[element(line[0]) * Elements + element(line[1])] = static_cast<uint8_t>(element(line[6]) + 1);
+    }
 
-      // account for new second pair
-      {
-        PolymerPair p{ r->second, k[1] };
-        auto np = new_pairs.insert({ p, 0 });
-        np.first->second += v;
+    constexpr void step() {
+      std::array<int64_t, Elements * Elements> next{};
+      for (size_t p = 0; p < pairs_.size(); p++) {
+        const int64_t v = pairs_[p];
+        if (!v) {
+          continue;
+        }
+        if (!rules_[p]) {
+          next[p] += v;
+          continue;
+        }
+        const size_t inserted = rules_[p] - 1;
+        next[(p / Elements) * Elements + inserted] += v;
+        next[inserted * Elements + p % Elements] += v;
+        counts_[inserted] += v;
       }
+      pairs_ = next;
+    }
 
-      // increment frequencies of newly inserted element
-      auto fit = f.insert(std::pair(r->second, 0));
-      fit.first->second += v;
+    // Most common element's count less the least common's
+    constexpr int64_t score() const {
+      int64_t min = INT64_MAX;
+      int64_t max = 0;
+      for (const auto v : counts_) {
+        if (v) {
+          min = std::min(v, min);
+          max = std::max(v, max);
+        }
+      }
+      return max - min;
     }
-    return new_pairs;
   };
 
-  const auto calculate_score = [](const Frequencies& f) {
-    size_t min = SIZE_MAX;
-    size_t max = 0;
-    for (const auto& [_, v] : f) {
-        (void)_;
-        min = std::min(v, min);
-        max = std::max(v, max);
-    }
+  constexpr std::string_view Sample = R"(NNCB
+
+CH -> B
+HH -> N
+CB -> H
+NH -> C
+HB -> C
+HC -> B
+HN -> C
+NN -> C
+BH -> H
+NC -> B
+NB -> B
+BN -> B
+BB -> N
+BC -> B
+CC -> N
+CN -> C)";
+
+  constexpr Polymer read(std::string_view input) {
+    Polymer p;
+    bool first = true;
+    aoc::ct::for_each_line(input, [&](std::string_view line) {
+      if (first) {
+        p.set_template(line);
+      } else {
+        p.add_rule(line);
+      }
+      first = false;
+    });
+    return p;
+  }
 
-    return max - min;
-  };
+  constexpr int64_t after(Polymer p, int steps) {
+    for (int i = 0; i < steps; i++) {
+      p.step();
+    }
+    return p.score();
+  }
 
+  constexpr aoc::SampleAnswers SampleSolution{ after(read(Sample), 10), after(read(Sample), 40) };
+  static_assert(SampleSolution == aoc::SampleAnswers(1588, 2188189693529));
 }
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  std::string line;
+  std::string_view line;
   aoc::getline(f, line);
 
-  Frequencies freq;
-  PolymerPair pair{ 0, 0 };
-  PolymerPairCounts pc;
-
-  // Initialize the chain as a count of every polymer pair and get initial frequencies
-  for (const auto& c : line) {
-    pair[0] = pair[1];
-    pair[1] = c;
-    if (pair[0]) {
-      auto cit = pc.insert({ pair, 0 });
-      cit.first->second++;
-    }
-    auto fit = freq.insert(std::pair(c, 0));
-    fit.first->second++;
-  }
-
-  // Read the rules
-  InsertionRules rules;
+  Polymer polymer;
+  polymer.set_template(line);
   while (aoc::getline(f, line)) {
-    assert(line.size() == 7);
-    assert(line[2] == ' ');
-    assert(line[3] == '-');
-    assert(line[4] == '>');
-    assert(line[5] == ' ');
-    PolymerPair p{line[0], line[1]};
-    rules.insert(std::pair(p, line[6]));
+    polymer.add_rule(line);
   }
   f.close();
 
+  t.phase("part1");
   for (int i = 0; i < 40; i++) {
-    pc = step(pc, rules, freq);
+    polymer.step();
     if (i == 9) {
-      aoc::print_result(1, calculate_score(freq));
+      aoc::print_result(1, polymer.score());
+      t.phase("part2");
     }
   }
 
-  aoc::print_result(2, calculate_score(freq));
+  aoc::print_result(2, polymer.score());
   return 0;
 }
 
+AOC_REGISTER_DAY(14, run);
+AOC_REGISTER_SAMPLE_ANSWERS(14, SampleSolution);
@@ -1,80 +1,36 @@
 #include "aoc21/helpers.h"
+#include "aoc21/search.h"
 
 #include <vector>
-#include <map>
 
 namespace {
-  class Grid {
-  private:
-    std::vector<int> _g;
-    size_t _width;
-
-  public:
-    Grid()
-      : _width(SIZE_MAX)
-    { }
-
-    void set_width(size_t w) {
-      assert(!is_width_set());
-      _width = w;
-    }
-
-    size_t get_width() const {
-      assert(is_width_set());
-      return _width;
-    }
-
-    size_t get_height() const {
-      assert(is_width_set());
-      return _g.size() / _width;
-    }
-
-    bool is_width_set() const {
-      return _width != SIZE_MAX;
-    }
-
-    void push_back(int v) {
-      _g.push_back(v);
-    }
-
-    int get(size_t x, size_t y) const {
-      x = x % get_width();
-      y = y % get_height();
-      assert((x + y * _width) < _g.size());
-
-      return _g[x + y * _width];
-    }
-  };
-
-  using Point = std::pair<size_t, size_t>;
-  using CostMap = std::map<Point, int64_t>;
-  using VisitMap = std::multimap<size_t, Point>;
-
-  const std::vector<Point>Directions{
-    {  0,  1 },
-    {  0, -1 },
-    {  1,  0 },
-    { -1,  0 },
-  };
+  // Wraps, so the tiled map of part 2 reads straight through to the tile
+  using Grid = aoc::Grid2D<int>;
+
+  // Cells of the tiled map by y * width + x, queued by the risk taken to
+  // reach them. A step risks at most 9. A* with the distance left as the
+  // heuristic is no faster, the goal being the far corner.
+  using Queue = aoc::search::DialQueue<aoc::search::Entry<uint32_t, uint32_t>>;
+  constexpr size_t MaxStep = 9;
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
   Grid grid;
-  std::string line;
+  std::string_view line;
   while (aoc::getline(f, line)) {
-    if (!grid.is_width_set()) {
-      grid.set_width(line.size());
+    if (grid.height() == 0) {
+      grid = Grid::wrapping(line.size(), 0);
     }
 
-    assert(line.size() == grid.get_width());
-    for (const auto& c: line) {
+    grid.push_row(line, [](const char c) {
       assert(c >= '0' && c <= '9');
-      grid.push_back(c - '0');
-    }
+      return c - '0';
+    });
   }
   f.close();
 
@@ -83,52 +39,51 @@ int main(int argc, char** argv) {
 
   for (size_t i = 0; i < n_mult; i++) {
 
-    VisitMap to_visit;
-    CostMap costs;
-
-    to_visit.emplace(0, std::make_pair<size_t, size_t>(0, 0));
-
-    const ssize_t total_width = mult[i] * grid.get_width();
-    const ssize_t total_height = mult[i] * grid.get_height();
-
-    while (!to_visit.empty()) {
-      auto it = to_visit.begin();
-      size_t cost = it->first;
-      size_t x = it->second.first;
-      size_t y = it->second.second;
-      to_visit.erase(it);
-
-      auto r = costs.emplace(std::make_pair(x, y), cost);
-      if (!r.second) {
-        // not a new node
-        continue;
-      }
-
-      for (const auto& dx : Directions) {
-        const ssize_t new_x = dx.first + x;
-        const ssize_t new_y = dx.second + y;
-
-        if (new_x < 0 || new_x >= total_width) {
-          continue;
-        } else if (new_y < 0 || new_y >= total_height) {
-          continue;
+    t.phase(i == 0 ? "part1" : "part2");
+    const uint32_t total_width = mult[i] * grid.width();
+    const uint32_t total_height = mult[i] * grid.height();
+    const uint32_t goal = total_width * total_height - 1;
+
+    // Risk rises by one for every tile right or down, wrapping back to 1 after 9
+    const auto risk = [&](uint32_t x, uint32_t y) {
+      const uint32_t r = grid(x, y) + x / grid.width() + y / grid.height();
+      return r > 9 ? r - 9 : r;
+    };
+
+    // The lowest risk each cell has been queued at, so no worse route to it
+    // is queued after
+    std::vector<uint32_t> best(total_width * total_height, UINT32_MAX);
+    const auto expand = [&](uint32_t p, uint32_t cost, auto&& push) {
+      const uint32_t x = p % total_width;
+      const uint32_t y = p / total_width;
+      const auto step = [&](uint32_t nx, uint32_t ny) {
+        const uint32_t n = ny * total_width + nx;
+        const uint32_t r = risk(nx, ny);
+        if (cost + r < best[n]) {
+          DEBUG_PRINT("[ " << nx << ", " << ny << " ] -> " << (cost + r));
+          best[n] = cost + r;
+          push(n, r);
         }
-
-        const size_t init_cost = grid.get(new_x, new_y);
-        const size_t added_cost = (new_x / grid.get_width()) + (new_y / grid.get_height());
-        size_t new_cost = init_cost + added_cost;
-        if (new_cost > 9) { // wrap back to 1
-          new_cost -= 9;
-        }
-
-        DEBUG_PRINT("[ " << new_x << ", " << new_y << " ] -> " << (cost + new_cost));
-        to_visit.emplace(cost + new_cost, std::make_pair(new_x, new_y));
-      }
+      };
+      if (x > 0) { step(x - 1, y); }
+      if (x + 1 < total_width) { step(x + 1, y); }
+      if (y > 0) { step(x, y - 1); }
+      if (y + 1 < total_height) { step(x, y + 1); }
+    };
+
+    Queue queue(MaxStep);
+    aoc::search::BitVisited visited(total_width * total_height);
+    const auto lowest = aoc::search::dijkstra<uint32_t>(uint32_t(0), queue, visited, expand,
+      [goal](uint32_t p) { return p == goal; });
+    if (!lowest) {
+      throw std::runtime_error("No path to the bottom right");
     }
 
-    aoc::print_result(i + 1, costs.at(std::make_pair(total_width - 1, total_height - 1)));
+    aoc::note_footprint("costs", best);
+    aoc::print_result(i + 1, *lowest);
   }
 
   return 0;
 }
 
+AOC_REGISTER_DAY(15, run);
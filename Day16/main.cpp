@@ -31,16 +31,39 @@ namespace {
 
     size_t length; // in bits
 
-    std::vector<Packet> sub_packets; // sub packets of this packet
+    std::pmr::vector<Packet> sub_packets; // sub packets of this packet
     int64_t literal;
   public:
-    Packet(int v, int t)
+    // Allocator aware, so the whole tree lives in the arena the root was given
+    using allocator_type = std::pmr::polymorphic_allocator<Packet>;
+
+    Packet(int v, int t, allocator_type a = {})
       : version(v)
       , type(t)
+      , length(0)
+      , sub_packets(a)
       , literal(INT64_MIN)
     { }
 
-    static Packet read_packet(const BinaryValue& stream, size_t& pos, size_t& sum) {
+    Packet(const Packet& rhs, allocator_type a = {})
+      : version(rhs.version)
+      , type(rhs.type)
+      , length(rhs.length)
+      , sub_packets(rhs.sub_packets, a)
+      , literal(rhs.literal)
+    { }
+
+    Packet(Packet&& rhs, allocator_type a)
+      : version(rhs.version)
+      , type(rhs.type)
+      , length(rhs.length)
+      , sub_packets(std::move(rhs.sub_packets), a)
+      , literal(rhs.literal)
+    { }
+
+    Packet(Packet&&) = default;
+
+    static Packet read_packet(const BinaryValue& stream, size_t& pos, size_t& sum, allocator_type a) {
       // First 3 are version
       const int version = Packet::read_integer_value(stream, pos, 3);
       // Next 3 are type
@@ -48,7 +71,7 @@ namespace {
       // Read the packet
       sum += version;
       DEBUG_PRINT("Packet: Version: " << version << " Type: " << type << " sum: " << sum);
-      Packet p{version, type};
+      Packet p{version, type, a};
       p.consume(stream, pos, sum);
 
       return p;
@@ -143,7 +166,7 @@ namespace {
                   const size_t end_pos = n + pos;
                   DEBUG_PRINT("Sub packet lengths: " << n);
                   while (pos < end_pos) {
-                    sub_packets.push_back(read_packet(stream, pos, sum));
+                    sub_packets.push_back(read_packet(stream, pos, sum, sub_packets.get_allocator()));
                   }
                 }
                 break;
@@ -153,7 +176,7 @@ namespace {
                   size_t n = read_integer_value(stream, pos, 11);
                   DEBUG_PRINT("Sub packet count: " << n);
                   while (n > 0) {
-                    sub_packets.push_back(read_packet(stream, pos, sum));
+                    sub_packets.push_back(read_packet(stream, pos, sum, sub_packets.get_allocator()));
                     n--;
                   }
                 }
@@ -179,12 +202,13 @@ namespace {
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  std::string line;
+  std::string_view line;
   std::vector<BinaryValue> streams;
   while (aoc::getline(f, line)) {
     size_t stream_pos = 0;
@@ -204,11 +228,14 @@ int main(int argc, char** argv) {
 
   f.close();
 
-  aoc::AutoTimer t2("execute");
+  t.phase("solve");
+  AOC_PROFILE_SCOPE("execute");
+  thread_local aoc::Arena arena;
+  arena.reset();
   for (const auto& stream : streams) {
     size_t stream_pos = 0;
     size_t sum = 0;
-    const auto p = Packet::read_packet(stream, stream_pos, sum);
+    const auto p = Packet::read_packet(stream, stream_pos, sum, &arena);
 
     aoc::print_result(1, sum);
     const auto result = p.compute();
@@ -219,3 +246,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(16, run);
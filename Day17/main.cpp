@@ -42,10 +42,11 @@ namespace {
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
   TargetArea target;
   std::string tok;
@@ -72,6 +73,7 @@ int main(int argc, char** argv) {
   assert(!aoc::getline(f, tok, " =."));
   f.close();
 
+  t.phase("solve");
   const auto abs_min_y = std::abs(target.first.second);
   const auto closed_max_height = (abs_min_y - 1) * (abs_min_y / 2);
   DEBUG_PRINT("Closed form: " << closed_max_height);
@@ -104,3 +106,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(17, run);
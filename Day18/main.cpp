@@ -2,37 +2,58 @@
 #include <vector>
 
 namespace {
+  // Allocator aware, so a whole tree lives in the arena its root was given
   class Number {
+  public:
+    using allocator_type = std::pmr::polymorphic_allocator<Number>;
+
   protected:
     int value;
-    std::vector<Number> parts;
+    std::pmr::vector<Number> parts;
 
-    Number()
+    explicit Number(allocator_type a)
       : value(0)
+      , parts(a)
     { }
 
   public:
-    Number(int v)
+    Number(int v, allocator_type a = {})
       : value(v)
+      , parts(a)
     { }
 
-    Number(const Number& l, const Number&r)
-      : Number()
+    Number(const Number& l, const Number&r, allocator_type a)
+      : Number(a)
     {
+      parts.reserve(2);
       parts.emplace_back(l);
       parts.emplace_back(r);
     }
 
+    Number(const Number& rhs, allocator_type a = {})
+      : value(rhs.value)
+      , parts(rhs.parts, a)
+    { }
+
+    Number(Number&& rhs, allocator_type a)
+      : value(rhs.value)
+      , parts(std::move(rhs.parts), a)
+    { }
+
+    Number(Number&&) = default;
+    Number& operator=(Number&&) = default;
+
     // recursively build our tree
-    static Number from_string(const std::string& s, size_t& p) {
+    static Number from_string(const std::string& s, size_t& p, allocator_type a) {
       const auto c = s[p++];
       switch (c) {
         case '[':
         {
-          Number n;
-          n.parts.push_back(Number::from_string(s, p));
+          Number n(a);
+          n.parts.reserve(2);
+          n.parts.push_back(Number::from_string(s, p, a));
           p++;
-          n.parts.push_back(Number::from_string(s, p));
+          n.parts.push_back(Number::from_string(s, p, a));
           p++;
           return n;
         }
@@ -46,7 +67,7 @@ namespace {
         case '7':
         case '8':
         case '9':
-          return Number(c - '0');
+          return Number(c - '0', a);
         default:
           throw std::runtime_error("Bad input");
       }
@@ -69,6 +90,7 @@ namespace {
         if (n.parts.empty()) {
           // split
           if (n.value >= 10) {
+            n.parts.reserve(2);
             n.parts.push_back(n.value / 2); // round down
             n.parts.push_back((n.value + 1) / 2); // round up
             n.value = 0;
@@ -170,17 +192,20 @@ namespace {
 
   public:
     Number& operator+=(const Number& rhs) {
-      Number l(this->value);
+      Number l(this->value, parts.get_allocator());
       l.parts = std::move(this->parts);
 
-      this->parts.push_back(l);
+      this->parts.clear();
+      this->parts.reserve(2);
+      this->parts.push_back(std::move(l));
       this->parts.push_back(rhs);
       this->reduce();
       return *this;
     }
 
-    Number operator+(const Number& rhs) {
-      Number n(*this, rhs);
+    // Like +=, but the sum is a new tree allocated from a
+    Number add(const Number& rhs, allocator_type a) const {
+      Number n(*this, rhs, a);
       n.reduce();
       return n;
     }
@@ -204,25 +229,32 @@ namespace {
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("part1");
+
+  auto f = aoc::map_argv_1(argc, argv);
 
-  auto f = aoc::open_argv_1(argc, argv);
+  // The numbers last the whole solve; each part 2 sum only one iteration.
+  // Kept per thread, so a batch reuses the blocks of the input before.
+  thread_local aoc::Arena arena;
+  thread_local aoc::Arena scratch;
+  arena.reset();
 
   std::string line;
   size_t pos = 0;
   // First line is left most number
   aoc::getline(f, line);
-  Number l = Number::from_string(line, pos);
+  Number l = Number::from_string(line, pos, &arena);
   assert(pos == line.size());
   DEBUG_PRINT(l);
 
-  std::vector<Number> numbers;
+  std::pmr::vector<Number> numbers(&arena);
   numbers.push_back(l);
   // Keep adding each line
   while (aoc::getline(f, line)) {
     pos = 0;
-    const Number r = Number::from_string(line, pos);
+    const Number r = Number::from_string(line, pos, &arena);
     numbers.push_back(r);
     DEBUG_PRINT(r);
     l += r;
@@ -233,11 +265,13 @@ int main(int argc, char** argv) {
   aoc::print_result(1, l.magnitude());
   t.elapsed();
 
+  t.phase("part2");
   int max_mag = INT_MIN;
   for (size_t i = 0; i < numbers.size(); i++) {
     for (size_t j = i + 1; j < numbers.size(); j++) {
-      max_mag = std::max(max_mag, (numbers[i] + numbers[j]).magnitude());
-      max_mag = std::max(max_mag, (numbers[j] + numbers[i]).magnitude());
+      max_mag = std::max(max_mag, numbers[i].add(numbers[j], &scratch).magnitude());
+      max_mag = std::max(max_mag, numbers[j].add(numbers[i], &scratch).magnitude());
+      scratch.reset();
     }
   }
   aoc::print_result(2, max_mag);
@@ -245,3 +279,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(18, run);
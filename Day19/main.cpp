@@ -1,8 +1,9 @@
 #include "aoc21/helpers.h"
+#include "aoc21/parse_cache.h"
+#include "aoc21/thread_pool.h"
 #include <vector>
 #include <list>
 #include <set>
-#include <unordered_set>
 #include <map>
 
 namespace {
@@ -35,7 +36,11 @@ namespace {
     }
 
     bool operator==(const Point& b) const { return b.x == x && b.y == y && b.z == z; }
-    bool operator<(const Point& b) const { return x < b.x; }
+    bool operator<(const Point& b) const { return std::tie(x, y, z) < std::tie(b.x, b.y, b.z); }
+
+    aoc::PackedPoint3 packed() const {
+      return aoc::PackedPoint3(x, y, z);
+    }
     Point& operator+=(const Point& rhs) {
       x += rhs.x;
       y += rhs.y;
@@ -63,23 +68,10 @@ namespace {
     }
   };
 
-  struct PointHash {
-    std::size_t operator() (const Point& pt) const {
-      // [ x | y | z]
-      // assume they are all less than 21 bits
-      assert (pt.x < (1 << 22));
-      assert (pt.y < (1 << 22));
-      assert (pt.z < (1 << 22));
-      size_t v = pt.x;
-      v <<= 21;
-      v |= pt.y;
-      v <<= 21;
-      v |= pt.z;
-      return v;
-    }
-  };
   using Beacons = std::vector<Point>;
-  using BeaconSet = std::unordered_set<Point, PointHash>;
+  // Absolute beacon positions are a few thousand at most, well inside the
+  // 21 bits a coordinate PackedPoint3 has
+  using BeaconSet = aoc::FlatHashSet<aoc::PackedPoint3>;
 
   const auto rotate = [](int i, const Point& b) {
     switch (i) {
@@ -127,8 +119,10 @@ namespace {
     BeaconSet get_beacon_set() const {
       // make all beacons absolute relative to our position
       BeaconSet out;
-      std::transform(beacons.begin(), beacons.end(), std::inserter(out, out.end()),
-        [this](const auto& b) { return this->abs_beacon_location(b); });
+      out.reserve(beacons.size());
+      for (const auto& b : beacons) {
+        out.insert(abs_beacon_location(b).packed());
+      }
       return out;
     }
 
@@ -147,18 +141,23 @@ namespace {
   using ScannerList = std::list<Scanner>;
   using Scanners = std::vector<Scanner>;
 
+  // The parse cache holds every beacon in input order, then the number of
+  // them each scanner saw. Bump whenever either changes.
+  constexpr uint32_t CacheVersion = 1;
+
   const auto count_matches = [](const Scanner& base, Scanner& s) {
     const auto base_beacons = base.get_beacon_set();
 
     for (int o = 0 ; o < 24; o++) {
       s.orientation = o;
 
-      for (const auto& pos : base_beacons) {
+      for (const auto& packed : base_beacons) {
+        const Point pos(packed.x(), packed.y(), packed.z());
         for (size_t i = 0; i < s.beacons.size(); i++) {
           s.set_beacon_abs(i, pos);
           size_t match = 0;
           for (const auto& c : s.get_beacons()) {
-            match += (base_beacons.find(c) != base_beacons.end());
+            match += base_beacons.contains(c.packed());
           }
           if (match >= 12) {
             DEBUG_PRINT("Scanner " << s.id << " pos: " << s.pos << " @ " << s.orientation);
@@ -181,36 +180,43 @@ namespace {
     std::set<std::pair<size_t, size_t>> no_match;
 
     while (!input.empty()) {
-      for (const auto& base : out) {
-        bool matched = false;
-        auto it = input.begin();
-        for (size_t i = 0; i < input.size(); i++) {
-          auto& s = *it;
-          std::pair<size_t, size_t> id_pair{base.id, s.id};
-
-          // optimizations from SalusaSecondus
-          if (no_match.find(id_pair) != no_match.end()) {
-            it++;
-            continue;
+      for (size_t b = 0; b < out.size(); b++) {
+        const auto& base = out[b];
+
+        // optimizations from SalusaSecondus
+        std::vector<Scanner*> candidates;
+        for (auto& s : input) {
+          if (no_match.find(std::make_pair(base.id, s.id)) == no_match.end()) {
+            candidates.push_back(&s);
           }
+        }
 
-          const auto does_match = count_matches(base, s);
-          // need at least 12 matches
-          if (does_match) {
-            DEBUG_PRINT("Matched: " << base.id << " with " << s.id);
-            out.emplace_back(s);
-            input.erase(it);
-            matched = true;
-            break;
+        // Each candidate only touches its own position and orientation
+        std::vector<uint8_t> matches(candidates.size());
+        aoc::parallel_for(0, candidates.size(), [&](const size_t i) {
+          matches[i] = count_matches(base, *candidates[i]);
+        }, 1);
+
+        // need at least 12 matches; take every scanner that has them, in input order
+        Scanners matched;
+        for (size_t i = 0; i < candidates.size(); i++) {
+          if (matches[i]) {
+            DEBUG_PRINT("Matched: " << base.id << " with " << candidates[i]->id);
+            matched.push_back(*candidates[i]);
           } else {
             // optimizations from SalusaSecondus
-            no_match.emplace(id_pair);
-            no_match.emplace(s.id, base.id);
+            no_match.emplace(base.id, candidates[i]->id);
+            no_match.emplace(candidates[i]->id, base.id);
           }
-          it++;
         }
 
-        if (matched) {
+        if (!matched.empty()) {
+          input.remove_if([&](const Scanner& s) {
+            return std::any_of(matched.begin(), matched.end(), [&](const Scanner& m) { return m.id == s.id; });
+          });
+          for (const auto& m : matched) {
+            out.push_back(m);
+          }
           DEBUG_PRINT("[ left: " << input.size() << " done: " << out.size() << " ]");
           break;
         }
@@ -221,43 +227,71 @@ namespace {
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  std::string line;
+  aoc::ParseCache cache("Day19", CacheVersion, f.remaining());
   ScannerList sq;
-  while (aoc::getline(f, line)) {
-    if (line.find("scanner") != std::string::npos) {
-      DEBUG_PRINT("Scanner: " << sq.size());
+  if (cache.load()) {
+    const auto beacons = cache.section<Point>(0);
+    size_t at = 0;
+    for (const auto n : cache.section<uint32_t>(1)) {
+      if (n > beacons.size() - at) {
+        throw std::runtime_error("Invalid parse cache " + cache.path());
+      }
       sq.emplace_back(sq.size());
-    } else {
-
-      Scanner& s = sq.back();
-      int x = INT_MAX;
-      int y = INT_MAX;
-      int z = INT_MAX;
-      
-      aoc::parse_as_integers(line, ',', [&x, &y, &z](const int v) {
-        if (x == INT_MAX) { x = v; }
-        else if (y == INT_MAX) { y = v; }
-        else { z = v; }
-      });
-      s.beacons.emplace_back(x, y, z);
-      DEBUG_PRINT("Beacon(" << s.beacons.size() << "): " << s.beacons.back());
+      sq.back().beacons.assign(beacons.begin() + at, beacons.begin() + at + n);
+      at += n;
+    }
+  } else {
+    std::string line;
+    while (aoc::getline(f, line)) {
+      if (line.find("scanner") != std::string::npos) {
+        DEBUG_PRINT("Scanner: " << sq.size());
+        sq.emplace_back(sq.size());
+      } else {
+
+        Scanner& s = sq.back();
+        int x = INT_MAX;
+        int y = INT_MAX;
+        int z = INT_MAX;
+
+        aoc::parse_as_integers(line, ',', [&x, &y, &z](const int v) {
+          if (x == INT_MAX) { x = v; }
+          else if (y == INT_MAX) { y = v; }
+          else { z = v; }
+        });
+        s.beacons.emplace_back(x, y, z);
+        DEBUG_PRINT("Beacon(" << s.beacons.size() << "): " << s.beacons.back());
+      }
+    }
+    if (cache.enabled()) {
+      Beacons beacons;
+      std::vector<uint32_t> counts;
+      for (const auto& s : sq) {
+        beacons.insert(beacons.end(), s.beacons.begin(), s.beacons.end());
+        counts.push_back(static_cast<uint32_t>(s.beacons.size()));
+      }
+      cache.add(beacons);
+      cache.add(counts);
+      cache.store();
     }
   }
   f.close();
 
+  t.phase("part1");
   BeaconSet beacons;
   const auto& scanners = build_map(sq);
   for (const auto& s : scanners) {
     for (const auto& b : s.get_beacons()) {
-      beacons.emplace(b);
+      beacons.insert(b.packed());
     }
   }
 
+  t.phase("part2");
   size_t max_dist = 0;
   for (const auto& s1 : scanners) {
     for (const auto& s2 : scanners) {
@@ -271,3 +305,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(19, run);
@@ -1,70 +1,83 @@
 #include "aoc21/helpers.h"
-#include <set>
 
 namespace {
-    using Movement = std::pair<char, int>;
+  // Position after following the course, both ways of reading it at once:
+  // part 1 takes up and down as moving the depth, part 2 as turning the aim
+  class Course {
+  public:
+    int horizontal = 0;
+    int aim = 0;
+    int depth = 0;
 
-    constexpr std::string_view DIRECTION_FORWARD("forward");
-    constexpr std::string_view DIRECTION_UP("up");
-    constexpr std::string_view DIRECTION_DOWN("down");
+    // Takes "forward 5", "down 5" or "up 3"
+    constexpr void follow(std::string_view line) {
+      const auto pos = line.find(' ');
+      if (pos == std::string_view::npos) {
+        throw std::runtime_error("Invalid input");
+      }
+      const int value = aoc::ct::to_integer(line.substr(pos + 1));
 
-    std::set<std::string_view> DIRECTIONS = {
-      DIRECTION_FORWARD,
-      DIRECTION_UP,
-      DIRECTION_DOWN,
-    };
-};
-
-int main(int argc, char** argv) {
-  aoc::AutoTimer t;
+      switch (line[0]) {
+        case 'd':
+          aim += value;
+          break;
+        case 'u':
+          aim -= value;
+          break;
+        case 'f':
+          horizontal += value;
+          depth += value * aim;
+          break;
+        default:
+          throw std::runtime_error("Invalid input");
+      }
+    }
 
-  auto f = aoc::open_argv_1(argc, argv);
+    constexpr int part1() const {
+      return aim * horizontal;
+    }
 
-  // Part 1
-  int virt = 0;
-  int horiz = 0;
+    constexpr int part2() const {
+      return horizontal * depth;
+    }
+  };
 
-  // Part 2
-  int depth = 0;
+  constexpr std::string_view Sample = R"(forward 5
+down 5
+forward 8
+up 3
+down 8
+forward 2
+)";
 
-  const auto parse_movement = [](const std::string &s) {
-    const auto pos = s.find(' ');
-    assert(pos != std::string::npos);
+  constexpr Course plot(std::string_view input) {
+    Course c;
+    aoc::ct::for_each_line(input, [&c](std::string_view line) { c.follow(line); });
+    return c;
+  }
 
-    const std::string_view direction(&s[0], pos);
-    const int value = ::atoi(&s[pos + 1]);
+  constexpr aoc::SampleAnswers SampleSolution{ plot(Sample).part1(), plot(Sample).part2() };
+  static_assert(SampleSolution == aoc::SampleAnswers(150, 900));
+};
 
-    assert(DIRECTIONS.find(direction) != DIRECTIONS.end());
-    
-    Movement m = std::make_pair(direction[0], value);
-    return m;
-  };
+static int run(int argc, char** argv) {
+  aoc::AutoTimer t;
+  t.phase("solve");
 
-  const auto walk_path = [&](const std::string& line) {
-    const Movement m = parse_movement(line);
-    switch (m.first) {
-      case 'd':
-        virt += m.second;
-        break;
-      case 'u':
-        virt -= m.second;
-        break;
-      case 'f':
-        horiz += m.second;
-        depth += (m.second * virt);
-        break;
-      default:
-        break;
-    }
-  };
+  // One pass in constant memory, so the course can be piped in as it is planned
+  auto f = aoc::stream_argv_1(argc, argv);
 
-  std::string l;
+  Course c;
+  f.on_idle([&c]() { aoc::print_running(c.part1(), c.part2()); });
+  std::string_view l;
   while (aoc::getline(f, l)) {
-    walk_path(l);
+    c.follow(l);
   }
 
-  aoc::print_results((virt * horiz), (horiz * depth));
+  aoc::print_results(c.part1(), c.part2());
 
   return 0;
 }
 
+AOC_REGISTER_DAY(2, run);
+AOC_REGISTER_SAMPLE_ANSWERS(2, SampleSolution);
@@ -1,140 +1,281 @@
 #include "aoc21/helpers.h"
+#include "aoc21/automaton.h"
 #include <vector>
-#include <set>
+#include <array>
 #include <chrono>
+#include <map>
 #include <thread>
+#include <tuple>
+#include <utility>
 
 namespace {
-  using Point = aoc::Point;
-  using Algorithm = std::vector<bool>;     // Light points are true
-  using Grid = std::set<Point>;            // Only lit points are stored
-
-  const std::vector<Point> offsets{
-    { -1, -1 },
-    {  0, -1 },
-    {  1, -1 },
-    { -1,  0 },
-    {  0,  0 },
-    {  1,  0 },
-    { -1,  1 },
-    {  0,  1 },
-    {  1,  1 },
-  };
-  
-  class Image {
-  protected:
-    Grid grid_;
-    Point top_left_;
-    Point bottom_right_;
-    bool is_back_lit_;
+  using Rule = std::array<bool, 512>; // true where the 3x3 pattern lights the pixel
+  using Grid = aoc::automaton::Automaton<1>;
+  using Window = aoc::automaton::Window<1>;
+  using Out = std::array<uint64_t*, 1>;
 
+  // The rule as a reduced ordered decision diagram over the 9 pixels of a
+  // pattern, so that it lights 64 pixels at once with bitwise operations.
+  // Pixel 8 is the top left of the pattern and pixel 0 the bottom right,
+  // as in the rule's index. Nodes 0 and 1 are the constants, and every
+  // other node comes after both of its children.
+  class Diagram {
   public:
+    // Most nodes any rule needs: each pixel can have no more nodes than
+    // there are paths down to it, or functions of the pixels below it
+    static constexpr size_t MaxNodes = []() {
+      size_t n = 2;
+      for (size_t p = 0; p < 9; p++) {
+        const size_t paths = size_t(1) << (8 - p);
+        n += p < 3 ? std::min<size_t>(paths, size_t(1) << (size_t(1) << (p + 1))) : paths;
+      }
+      return n;
+    }();
+
+    class Node {
+    public:
+      uint8_t pixel;
+      uint16_t lo;
+      uint16_t hi;
+    };
 
-    Image()
-      : top_left_(0, 0)
-      , bottom_right_(0, 0)
-      , is_back_lit_(false)
+  private:
+    std::vector<Node> nodes_;
+    uint16_t root_;
+
+  public:
+    explicit Diagram(const Rule& rule)
+      : nodes_(2)
+      , root_(0)
     {
+      // Bottom up: each pass folds pixel p out of the patterns, pairing
+      // those that differ only in it
+      std::vector<uint16_t> ids(rule.begin(), rule.end());
+      std::map<std::tuple<uint8_t, uint16_t, uint16_t>, uint16_t> unique;
+      for (uint8_t p = 0; p < 9; p++) {
+        for (size_t i = 0; i < ids.size() / 2; i++) {
+          const uint16_t lo = ids[2 * i];
+          const uint16_t hi = ids[2 * i + 1];
+          if (lo == hi) {
+            ids[i] = lo;
+            continue;
+          }
+          const auto [it, fresh] = unique.emplace(std::make_tuple(p, lo, hi), static_cast<uint16_t>(nodes_.size()));
+          if (fresh) {
+            nodes_.push_back(Node{ p, lo, hi });
+          }
+          ids[i] = it->second;
+        }
+        ids.resize(ids.size() / 2);
+      }
+      assert(nodes_.size() <= MaxNodes);
+      root_ = ids[0];
     }
 
-    bool get(const Point& pt) const {
-      return get(pt, is_back_lit_);
+    const std::vector<Node>& nodes() const { return nodes_; }
+    uint16_t root() const { return root_; }
+  };
+
+  // The rows above, at and below the one being lit, each readable from
+  // word -1 to word n
+  using Rows = std::array<const uint64_t*, 3>;
+
+  // Lights the n words of a row. The pixels of a pattern are its rows'
+  // words shifted a cell either way, pixel 8 - 3 * dy - dx being the cell
+  // dx - 1, dy - 1 away.
+  void light_scalar(const Diagram& d, const Rows& rows, uint64_t* out, size_t n) {
+    const auto& nodes = d.nodes();
+    for (size_t i = 0; i < n; i++) {
+      uint64_t in[9];
+      for (size_t dy = 0; dy < 3; dy++) {
+        const uint64_t* r = rows[dy] + i;
+        in[8 - 3 * dy] = (r[0] << 1) | (r[-1] >> 63);
+        in[7 - 3 * dy] = r[0];
+        in[6 - 3 * dy] = (r[0] >> 1) | (r[1] << 63);
+      }
+      uint64_t values[Diagram::MaxNodes];
+      values[0] = 0;
+      values[1] = ~uint64_t(0);
+      for (size_t k = 2; k < nodes.size(); k++) {
+        const uint64_t lo = values[nodes[k].lo];
+        values[k] = lo ^ (in[nodes[k].pixel] & (lo ^ values[nodes[k].hi]));
+      }
+      out[i] = values[d.root()];
     }
+  }
 
-    bool get(const Point& pt, bool is_back_lit) const {
-      if (pt.first < top_left_.first ||
-        pt.second < top_left_.second ||
-        pt.first > bottom_right_.first ||
-        pt.second > bottom_right_.second) {
-        return is_back_lit;
+#if defined(AOC_ISA_X86)
+  AOC_TARGET("avx2") void light_avx2(const Diagram& d, const Rows& rows, uint64_t* out, size_t n) {
+    const auto& nodes = d.nodes();
+    const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+    for (size_t i = 0; i < n; i += 4) {
+      // Lanes past the end of the row are neither read nor written
+      const __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<int64_t>(n - i)), lane);
+      __m256i in[9];
+      for (size_t dy = 0; dy < 3; dy++) {
+        const long long* r = reinterpret_cast<const long long*>(rows[dy] + i);
+        const __m256i c = _mm256_maskload_epi64(r, mask);
+        in[8 - 3 * dy] = _mm256_or_si256(_mm256_slli_epi64(c, 1), _mm256_srli_epi64(_mm256_maskload_epi64(r - 1, mask), 63));
+        in[7 - 3 * dy] = c;
+        in[6 - 3 * dy] = _mm256_or_si256(_mm256_srli_epi64(c, 1), _mm256_slli_epi64(_mm256_maskload_epi64(r + 1, mask), 63));
       }
+      __m256i values[Diagram::MaxNodes];
+      values[0] = _mm256_setzero_si256();
+      values[1] = _mm256_set1_epi64x(-1);
+      for (size_t k = 2; k < nodes.size(); k++) {
+        const __m256i lo = values[nodes[k].lo];
+        values[k] = _mm256_xor_si256(lo, _mm256_and_si256(in[nodes[k].pixel], _mm256_xor_si256(lo, values[nodes[k].hi])));
+      }
+      _mm256_maskstore_epi64(reinterpret_cast<long long*>(out + i), mask, values[d.root()]);
+    }
+  }
 
-      const auto r = grid_.find(pt);
-      if (r != grid_.end()) {
-        return true;
+  // GCC 12 takes the _mm512_undefined_epi32() inside these intrinsics for
+  // reads of uninitialized memory
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+  // Lights V vectors of 8 words from i on, reading each node once for all
+  // of them. A node is a bitwise select, one vpternlogq.
+  template<size_t V>
+  AOC_TARGET("avx512f") inline void light_avx512_words(const Diagram& d, const Rows& rows, uint64_t* out, size_t i, size_t n) {
+    __mmask8 mask[V];
+    __m512i in[9][V];
+    for (size_t v = 0; v < V; v++) {
+      const size_t at = i + 8 * v;
+      mask[v] = n - at >= 8 ? 0xff : static_cast<__mmask8>((1u << (n - at)) - 1);
+      for (size_t dy = 0; dy < 3; dy++) {
+        const uint64_t* r = rows[dy] + at;
+        const __m512i c = _mm512_maskz_loadu_epi64(mask[v], r);
+        in[8 - 3 * dy][v] = _mm512_or_si512(_mm512_slli_epi64(c, 1), _mm512_srli_epi64(_mm512_maskz_loadu_epi64(mask[v], r - 1), 63));
+        in[7 - 3 * dy][v] = c;
+        in[6 - 3 * dy][v] = _mm512_or_si512(_mm512_srli_epi64(c, 1), _mm512_slli_epi64(_mm512_maskz_loadu_epi64(mask[v], r + 1), 63));
+      }
+    }
+    __m512i values[Diagram::MaxNodes][V];
+    for (size_t v = 0; v < V; v++) {
+      values[0][v] = _mm512_setzero_si512();
+      values[1][v] = _mm512_set1_epi64(-1);
+    }
+    const auto& nodes = d.nodes();
+    for (size_t k = 2; k < nodes.size(); k++) {
+      const auto& node = nodes[k];
+      for (size_t v = 0; v < V; v++) {
+        values[k][v] = _mm512_ternarylogic_epi64(in[node.pixel][v], values[node.hi][v], values[node.lo][v], 0xca);
       }
-      return false;
     }
+    for (size_t v = 0; v < V; v++) {
+      _mm512_mask_storeu_epi64(out + i + 8 * v, mask[v], values[d.root()][v]);
+    }
+  }
 
-    void light_up(const Point& pt) {
-      light_up(grid_, pt, top_left_, bottom_right_);
+  AOC_TARGET("avx512f") void light_avx512(const Diagram& d, const Rows& rows, uint64_t* out, size_t n) {
+    size_t i = 0;
+    for (; i + 24 < n; i += 32) {
+      light_avx512_words<4>(d, rows, out, i, n);
+    }
+    if (i + 8 >= n) {
+      light_avx512_words<1>(d, rows, out, i, n);
+    } else if (i + 16 >= n) {
+      light_avx512_words<2>(d, rows, out, i, n);
+    } else {
+      light_avx512_words<3>(d, rows, out, i, n);
     }
+  }
+#pragma GCC diagnostic pop
 
-    void light_up(Grid& g, const Point& pt, Point& top_left, Point& bottom_right) const {
-#if !defined(NDEBUG)
-      const auto r =
+  const aoc::isa::Kernel<void(const Diagram&, const Rows&, uint64_t*, size_t)> light{ light_scalar, nullptr, light_avx2, light_avx512 };
+#else
+  const aoc::isa::Kernel<void(const Diagram&, const Rows&, uint64_t*, size_t)> light{ light_scalar };
 #endif
-        g.emplace(pt);
-      assert(r.second);
-
-      top_left.first = std::min(top_left.first, pt.first);
-      top_left.second = std::min(top_left.second, pt.second);
-      bottom_right.first = std::max(bottom_right.first, pt.first);
-      bottom_right.second = std::max(bottom_right.second, pt.second);
-    }
-
-    int value_of(const Point& p) const {
-      int v = 0;
-      for (const auto& o : offsets) {
-        Point pt{p.first + o.first, p.second + o.second};
-        const auto c = get(pt);
-        v <<= 1;
-        v |= (c == true);
-      }
-      assert(v < 512);
-      return v;
-    }
-
-    size_t enhance(const Algorithm& alg) {
-      size_t lit = 0;
-      
-      const int min_x = top_left_.first;
-      const int min_y = top_left_.second;
-      size_t height = bottom_right_.second - top_left_.second + 1;
-      size_t width = bottom_right_.first - top_left_.first + 1;
-
-      Grid new_grid;
-      // First, set the new grids background as it is infinite space
-      // and may toggle
-      bool is_back_lit;
-      {
-        const auto v = value_of({min_x - 3, min_y - 3});
-        is_back_lit = alg[v];
-      }
-      
-      // to enhance, get the binary value which represents the 9 pixels surrounding it
-      Point tl{0, 0};
-      Point br{0, 0};
-      for (size_t y = 0; y <= height + 2; y++) {
-        for (size_t x = 0; x <= width + 2; x++) {
-          const Point p{x + min_x - 1, y + min_y - 1};
-          const auto v = value_of(p);
-          if (alg[v]) {
-            light_up(new_grid, p, tl, br);
+
+  // The image on a square of pixels wide enough that it can not grow past
+  // the edge in the steps it is built for. The one pixel border stands for
+  // the infinite background, which toggles when the rule lights an empty
+  // pattern.
+  class Image {
+  protected:
+    Grid grid_;
+    const Rule& rule_;
+    Diagram diagram_;
+    bool back_lit_;
+    // Rows the image may have lit, where every other row is background
+    size_t top_;
+    size_t bottom_;
+
+    static size_t side(const std::vector<std::string_view>& rows, size_t steps) {
+      const size_t width = rows.empty() ? 0 : rows[0].size();
+      return std::max(width, rows.size()) + 2 * (steps + 2);
+    }
+
+  public:
+    Image(const std::vector<std::string_view>& rows, size_t steps, const Rule& rule)
+      : grid_(side(rows, steps), side(rows, steps))
+      , rule_(rule)
+      , diagram_(rule)
+      , back_lit_(false)
+      , top_(steps + 2)
+      , bottom_(steps + 2 + rows.size())
+    {
+      // A word at a time rather than set() a pixel at a time, whose branch
+      // on the pixel mispredicts all over a random image
+      const size_t margin = steps + 2;
+      auto& pixels = grid_.plane(0);
+      for (size_t y = 0; y < rows.size(); y++) {
+        const std::string_view row = rows[y];
+        uint64_t* r = pixels.row(y + margin);
+        for (size_t x = 0; x < row.size();) {
+          const size_t at = x + margin;
+          const size_t end = std::min(row.size(), x + 64 - (at & 63));
+          uint64_t word = 0;
+          for (; x < end; x++) {
+            assert(row[x] == '.' || row[x] == '#');
+            word |= static_cast<uint64_t>(row[x] == '#') << ((x + margin) & 63);
           }
-          lit += alg[v];
+          r[at >> 6] |= word;
         }
       }
-      grid_ = new_grid;
-      top_left_ = tl;
-      bottom_right_ = br;
-      is_back_lit_ = is_back_lit;
+    }
 
+    size_t enhance() {
+      const bool back_lit = rule_[back_lit_ ? 511 : 0];
+      const uint64_t back = back_lit ? ~uint64_t(0) : 0;
+      const size_t last = grid_.width() - 1;
+      const uint64_t end = uint64_t(1) << (last & 63);
+      const auto kernel = light.best();
+      const size_t lit = grid_.step([&](const Window& w, const Out& out) {
+        // Rows too far from the image to see anything but the background,
+        // and the border rows
+        uint64_t* r = out[0];
+        const size_t n = w.words();
+        if (w.y() + 1 < top_ || w.y() > bottom_ || w.y() == 0 || w.y() + 1 == grid_.height()) {
+          std::fill(r, r + n, back);
+          return uint64_t(0);
+        }
+        kernel(diagram_, Rows{ w.row(0, -1), w.row(0, 0), w.row(0, 1) }, r, n);
+        // The pixels at either end are the border, not counted as lit
+        r[0] &= ~uint64_t(1);
+        r[n - 1] &= ~end & w.valid(n - 1);
+        uint64_t lit = 0;
+        for (size_t i = 0; i < n; i++) {
+          lit += __builtin_popcountll(r[i]);
+        }
+        r[0] |= back & 1;
+        r[n - 1] |= back & end;
+        return lit;
+      });
+      back_lit_ = back_lit;
+      // The image grows by a pixel a step, up to the border
+      top_ = std::max<size_t>(top_, 2) - 1;
+      bottom_ = std::min(bottom_ + 1, grid_.height() - 1);
       return lit;
     }
 
-    friend std::ostream& operator<<(std::ostream& os, Image&im) {
-      const size_t height = im.bottom_right_.second - im.top_left_.second + 1;
-      const size_t width = im.bottom_right_.first - im.top_left_.first + 1;
-
-      for (size_t y = 0; y <= height; y++) {
-        for (size_t x = 0; x <= width; x++) {
-          const Point p{x + im.top_left_.first, y + im.top_left_.second};
-          if (im.get(p)) {
-              os << "#";
-          } else {
-              os << ".";
-          }
+    friend std::ostream& operator<<(std::ostream& os, const Image& im) {
+      const auto& pixels = std::as_const(im.grid_).plane(0);
+      for (size_t y = 0; y < pixels.height(); y++) {
+        for (size_t x = 0; x < pixels.width(); x++) {
+          os << (pixels.get(x, y) ? '#' : '.');
         }
         os << std::endl;
       }
@@ -144,50 +285,53 @@ namespace {
 
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
   // first line is algorithm
-  std::string line;
+  std::string_view line;
   aoc::getline(f, line);
-  assert(line.size() == 512);
-  Algorithm alg;
-  alg.reserve(line.size());
-  for (const auto& c: line) {
-    assert(c == '.' || c == '#');
-    alg.push_back(c == '#');
+  if (line.size() != 512) {
+    throw std::runtime_error("Invalid input");
+  }
+  Rule alg;
+  for (size_t i = 0; i < line.size(); i++) {
+    assert(line[i] == '.' || line[i] == '#');
+    alg[i] = line[i] == '#';
   }
-  Image image;
-  Point pt{0, 0};
+  std::vector<std::string_view> rows;
   while (aoc::getline(f, line)) {
-    pt.first = 0;
-    for (const auto& c : line) {
-      assert(c == '.' || c == '#');
-      if (c == '#') {
-        image.light_up(pt);
-      }
-      pt.first++;
+    if (line.empty()) {
+      continue;
+    }
+    // The image is sized from its first row
+    if (!rows.empty() && line.size() != rows[0].size()) {
+      throw std::runtime_error("Invalid input");
     }
-    pt.second++;
+    rows.push_back(line);
   }
+  Image image(rows, 50, alg);
   f.close();
 
   DEBUG(std::cout << aoc::cls << image << std::endl);
 
+  t.phase("part1");
   size_t lit1 = 0;
   for (int i = 0; i < 2; i++) {
-    lit1 = image.enhance(alg);
+    lit1 = image.enhance();
     if (i % 2) {
       DEBUG(std::this_thread::sleep_for (std::chrono::milliseconds(10)));
       DEBUG(std::cout << aoc::cls << image << std::endl);
     }
   }
 
+  t.phase("part2");
   size_t lit2 = 0;
   for (int i = 2; i < 50; i++) {
-    lit2 = image.enhance(alg);
+    lit2 = image.enhance();
     if (i % 2) {
       DEBUG(std::this_thread::sleep_for (std::chrono::milliseconds(10)));
       DEBUG(std::cout << aoc::cls << image << std::endl);
@@ -198,7 +342,7 @@ int main(int argc, char** argv) {
   DEBUG(
     bool show = true;
     while(1) {
-      image.enhance(alg);
+      image.enhance();
       show = !show;
       if (show) {
         DEBUG(std::this_thread::sleep_for (std::chrono::milliseconds(10)));
@@ -210,3 +354,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(20, run);
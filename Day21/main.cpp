@@ -1,136 +1,153 @@
 #include "aoc21/helpers.h"
 #include <array>
-#include <vector>
-#include <map>
 
 namespace {
+  constexpr int Spaces = 10;
+  constexpr int PracticeTarget = 1000;
+  constexpr int DiracTarget = 21;
+  // Every turn scores at least 1, so a Dirac game is over by this turn
+  constexpr int MaxTurns = DiracTarget;
+
+  constexpr int advance(int space, int move) {
+    return (space - 1 + move) % Spaces + 1;
+  }
 
-  using Player = std::pair<int, int>;
+  // Part 1: the deterministic 100 sided die, rolled three times a turn.
+  // Returns the loser's score times the number of rolls.
+  constexpr int64_t practice(int space1, int space2) {
+    std::array<int, 2> space{ space1, space2 };
+    std::array<int64_t, 2> score{};
+    int64_t rolls = 0;
+    int die = 1;
+    int turn = 0;
+    while (true) {
+      int move = 0;
+      for (int i = 0; i < 3; i++) {
+        move += die;
+        die = die % 100 + 1;
+      }
+      rolls += 3;
+      space[turn] = advance(space[turn], move);
+      score[turn] += space[turn];
+      if (score[turn] >= PracticeTarget) {
+        return score[!turn] * rolls;
+      }
+      turn = !turn;
+    }
+  }
 
-  class Die {
-  protected:
-    int value;
-    size_t rolls;
-    const int sides;
+  // Pair of Outcome + Ways to get there from 3 rolls
+  constexpr std::array<std::pair<int, int64_t>, 7> QuantumRolls{{
+    {6,7}, {5,6}, {7,6}, {4,3}, {8,3}, {3,1}, {9,1},
+  }};
 
+  // One player's games on their own, by turn: the universes in which they
+  // first reach 21 on that turn, and those in which they still have not
+  // once it is over. Neither player's rolls affect the other's, so the two
+  // players' tables are all it takes to count every game.
+  class Turns {
   public:
-    Die()
-      : value(1)
-      , rolls(0)
-      , sides(100)
-    { }
-
-    int roll() {
-      const auto r = value;
-      value++;
-      if (value > sides) { value -= sides; }
-      rolls++;
-      return r;
+    std::array<int64_t, MaxTurns + 1> won{};
+    std::array<int64_t, MaxTurns + 1> playing{};
+  };
+
+  constexpr Turns dirac_turns(int start) {
+    // Universes by space and score, scores below the target only
+    using Board = std::array<int64_t, Spaces * DiracTarget>;
+    Board at{};
+    at[(start - 1) * DiracTarget] = 1;
+
+    Turns t;
+    t.playing[0] = 1;
+    for (int turn = 1; turn <= MaxTurns; turn++) {
+      Board next{};
+      for (int space = 1; space <= Spaces; space++) {
+        for (int score = 0; score < DiracTarget; score++) {
+          const int64_t count = at[(space - 1) * DiracTarget + score];
+          if (!count) {
+            continue;
+          }
+          for (const auto& [roll, ways] : QuantumRolls) {
+            const int s = advance(space, roll);
+            if (score + s >= DiracTarget) {
+              t.won[turn] += count * ways;
+            } else {
+              next[(s - 1) * DiracTarget + score + s] += count * ways;
+              t.playing[turn] += count * ways;
+            }
+          }
+        }
+      }
+      at = next;
     }
+    return t;
+  }
 
-    size_t get_rolls() const {
-      return rolls;
+  // Part 2: universes in which the player who wins in more of them wins.
+  // Player 1 wins on their turn n if player 2 is still playing after n - 1
+  // turns, player 2 on their turn n if player 1 still is after n.
+  constexpr int64_t dirac(int space1, int space2) {
+    const auto p1 = dirac_turns(space1);
+    const auto p2 = dirac_turns(space2);
+    int64_t wins1 = 0;
+    int64_t wins2 = 0;
+    for (int turn = 1; turn <= MaxTurns; turn++) {
+      wins1 += p1.won[turn] * p2.playing[turn - 1];
+      wins2 += p2.won[turn] * p1.playing[turn];
     }
-  };
+    return std::max(wins1, wins2);
+  }
 
-  using State = std::tuple<int, int, int, int>;
-  // Pair of Outcome + Ways to get there from 3 rolls
-  const std::vector<std::pair<int, int64_t>> QuantumRolls{
-    {6,7}, {5,6}, {7,6}, {4,3}, {8,3}, {3,1}, {9,1},
-  };
+  // Takes "Player 1 starting position: 4"
+  constexpr int starting_space(std::string_view line) {
+    const auto p = line.rfind(' ');
+    const int space = p == std::string_view::npos ? 0 : aoc::ct::to_integer(line.substr(p + 1));
+    if (space < 1 || space > Spaces) {
+      throw std::runtime_error("Invalid input");
+    }
+    return space;
+  }
 
-  // map of State (finite) -> wins
-  using Universe = std::map<State, int64_t>;
+  constexpr std::string_view Sample = R"(Player 1 starting position: 4
+Player 2 starting position: 8)";
+
+  constexpr std::array<int, 2> read(std::string_view input) {
+    std::array<int, 2> spaces{};
+    size_t i = 0;
+    aoc::ct::for_each_line(input, [&](std::string_view line) { spaces[i++] = starting_space(line); });
+    return spaces;
+  }
+
+  constexpr aoc::SampleAnswers SampleSolution{ practice(read(Sample)[0], read(Sample)[1]), dirac(read(Sample)[0], read(Sample)[1]) };
+  static_assert(SampleSolution == aoc::SampleAnswers(739785, 444356092776315));
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  std::array<Player, 2> players{ };
+  std::array<int, 2> spaces{ };
   {
     size_t i = 0;
-    std::string line;
+    std::string_view line;
     while (i < 2 && aoc::getline(f, line)) {
-      const auto p = line.size() - 1;
-      assert(line[p] >= '1' && line[p] <= '9');
-      const int pos = line[p] - '0';
-      players[i].first = pos;
-      players[i].second = 0;
-      i++;
+      spaces[i++] = starting_space(line);
     }
-
-    assert(i == 2);
-  }
-
-  // Initial state for part 2
-  Universe u{
-    { std::make_tuple(players[0].first, players[0].second, players[1].first, players[1].second), 1 }
-  };
-
-  bool turn = 0;
-  Die die{};
-  while (players[0].second < 1000 &&
-      players[1].second < 1000)
-  {
-    const auto move = die.roll() + die.roll() + die.roll();
-    players[turn].first += move;
-    while (players[turn].first > 10) { players[turn].first -= 10; }
-    players[turn].second += players[turn].first;
-
-    DEBUG_PRINT("Player " << (static_cast<int>(turn) + 1) << " Score: " << players[turn].second << " Space: " << players[turn].first);
-    turn = !turn;
-  }
-
-  aoc::print_result(1, die.get_rolls() * players[turn].second);
-
-  // Generate all possible set of outcomes - this is limited, and for each one, either 1 or 2 can win
-  std::pair<int64_t, int64_t>wins{0, 0};
-
-  // universe is a map of all non-terminal states with their frequencies, we loop until there are no non-terminal states
-  while (!u.empty()) {
-    DEBUG_PRINT("Non-terminal states: " << u.size());
-    Universe t;
-
-    for (auto& [state, count] : u) {
-      // unpack the state
-      std::tie(players[0].first, players[0].second, players[1].first, players[1].second) = state;
-      for (const auto& [ roll1, ways1 ] : QuantumRolls) {
-        // advance player 1
-        Player p1(players[0]);
-        p1.first = p1.first + roll1;
-        while (p1.first > 10) { p1.first -= 10; }
-        p1.second += p1.first;
-        int64_t outcomes = count * ways1;
-        if (p1.second >= 21) { // player 1 wins
-          wins.first += outcomes;
-          continue;
-        }
-
-        for (const auto& [ roll2, ways2 ] : QuantumRolls) {
-          // advance player 2
-          Player p2(players[1]);
-          p2.first = p2.first + roll2;
-          while (p2.first > 10) { p2.first -= 10; }
-          p2.second += p2.first;
-          if (p2.second >= 21) { // player 2 wins
-            wins.second += outcomes * ways2;
-            continue;
-          }
-
-          // else, new state
-          auto r = t.emplace(std::make_tuple(p1.first, p1.second, p2.first, p2.second), 0);
-          r.first->second += outcomes * ways2;
-        }
-      }
+    if (i != 2) {
+      throw std::runtime_error("Invalid input");
     }
-
-    std::swap(t, u);
   }
 
-  aoc::print_result(2, std::max(wins.first, wins.second));
+  t.phase("part1");
+  aoc::print_result(1, practice(spaces[0], spaces[1]));
+
+  t.phase("part2");
+  aoc::print_result(2, dirac(spaces[0], spaces[1]));
 
   return 0;
 }
 
+AOC_REGISTER_DAY(21, run);
+AOC_REGISTER_SAMPLE_ANSWERS(21, SampleSolution);
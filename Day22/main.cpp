@@ -1,4 +1,5 @@
 #include "aoc21/helpers.h"
+#include "aoc21/parse_cache.h"
 #include <vector>
 
 namespace {
@@ -7,6 +8,17 @@ namespace {
   class Cube;
   using CubeList = std::vector<Cube>;
 
+  // A line of the reboot as kept in the parse cache: whether it turns the
+  // cubes on, then the x, y and z ranges
+  class Step {
+  public:
+    int32_t on;
+    int32_t range[6];
+  };
+
+  // Bump whenever Step changes
+  constexpr uint32_t CacheVersion = 1;
+
   class Cube {
   public:
     Point range_x;
@@ -58,6 +70,16 @@ namespace {
       , range_z(z)
     { }
 
+    explicit Cube(const Step& s)
+      : range_x(s.range[0], s.range[1])
+      , range_y(s.range[2], s.range[3])
+      , range_z(s.range[4], s.range[5])
+    { }
+
+    Step step(bool on) const {
+      return Step{ on, { range_x.first, range_x.second, range_y.first, range_y.second, range_z.first, range_z.second } };
+    }
+
     size_t volume() const {
       size_t width = range_x.second - range_x.first + 1;
       size_t height = range_y.second - range_y.first + 1;
@@ -126,14 +148,31 @@ namespace {
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
+
+  auto f = aoc::map_argv_1(argc, argv);
+  aoc::ParseCache cache("Day22", CacheVersion, f.remaining());
+  std::vector<Step> steps;
+  if (cache.load()) {
+    const auto cached = cache.section<Step>(0);
+    steps.assign(cached.begin(), cached.end());
+  } else {
+    std::string line;
+    while (aoc::getline(f, line)) {
+      // If this line starts with on, then the cube is added
+      steps.push_back(Cube(line).step(line[1] == 'n'));
+    }
+    cache.add(steps);
+    cache.store();
+  }
+  f.close();
 
-  auto f = aoc::open_argv_1(argc, argv);
-  std::string line;
+  t.phase("solve");
   CubeList cubes;
-  while (aoc::getline(f, line)) {
-    Cube c(line);
+  for (const auto& step : steps) {
+    const Cube c(step);
 
     CubeList new_cubes;
     for (const auto& i : cubes) {
@@ -143,15 +182,14 @@ int main(int argc, char** argv) {
         new_cubes.emplace_back(i);
       }
     }
-    // If this line starts with on, then add this cube
-    if (line[1] == 'n') {
+    if (step.on) {
       DEBUG_PRINT(c);
       new_cubes.emplace_back(c);
     }
 
     std::swap(cubes,new_cubes);
   }
-  f.close();
+  aoc::note_footprint("cubes", cubes);
 
   size_t part1 = 0;
   size_t part2 = 0;
@@ -166,3 +204,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(22, run);
@@ -1,9 +1,9 @@
 #include "aoc21/helpers.h"
+#include "aoc21/search.h"
 #include <array>
 #include <algorithm>
 #include <list>
 #include <map>
-#include <set>
 #include <vector>
 
 namespace {
@@ -39,11 +39,12 @@ namespace {
     int roomDepth;
     Hallway hallway;
     Rooms rooms;
-    std::vector<int>doorways;
+    std::array<int, RoomCount> doorways;
 
     MapState(int depth)
       : energy(0)
       , roomDepth(depth)
+      , doorways()
     {
       for (auto& c : hallway) {
         c = '.';
@@ -65,16 +66,23 @@ namespace {
       roomDepth = rooms[0].size();
     }
 
-    std::string hash() const {
-      std::string s;
-      for (const auto&c : hallway) {
-        s.append(&c, 1);
+    // Packs the state: three bits per hallway cell in the first word, and
+    // for each room its size and two bits per fish in the second
+    using Key = std::pair<uint64_t, uint64_t>;
+    Key key() const {
+      Key k{ 0, 0 };
+      for (const auto& c : hallway) {
+        k.first = (k.first << 3) | (IsFish(c) ? c - 'A' + 1 : 0);
       }
       for (const auto& r : rooms) {
-        s.append(",", 1);
-        s.append(r);
+        assert(r.size() <= 4);
+        k.second = (k.second << 3) | r.size();
+        for (const auto& c : r) {
+          k.second = (k.second << 2) | (c - 'A');
+        }
+        k.second <<= 2 * (4 - r.size());
       }
-      return s;
+      return k;
     }
 
     bool isDesiredRoom(char fish, int room) const {
@@ -121,7 +129,7 @@ namespace {
       return -1;
     }
 
-    MapState move(int from, int to) {
+    MapState move(int from, int to) const {
       MapState next(*this);
 
       auto fish = next.hallway[from];
@@ -222,6 +230,31 @@ namespace {
       return isTargetRoomClear(to) && isHallwayClear(i + 1, j);
     }
 
+    // Energy still needed if no fish were in the way: each walks to the
+    // nearest cell of its own room, or stays put if it is in it already.
+    // A move costs at least what it brings its fish closer by, so this never
+    // falls by more than a move costs, and A* can take it as its heuristic.
+    int lower_bound() const {
+      int energy = 0;
+      for (int r = 0; r < RoomCount; r++) {
+        const int size = rooms[r].size();
+        for (int j = 0; j < size; j++) {
+          const char fish = rooms[r][j];
+          const int t = TargetRoom(fish);
+          if (t != r) {
+            const int depth = roomDepth - size + j + 1;
+            energy += (depth + ::abs(doorways[r] - doorways[t]) + 1) * EnergyCost[fish];
+          }
+        }
+      }
+      for (int x = 0; x < HallwaySize; x++) {
+        if (IsFish(hallway[x])) {
+          energy += (::abs(x - doorways[TargetRoom(hallway[x])]) + 1) * EnergyCost[hallway[x]];
+        }
+      }
+      return energy;
+    }
+
     bool valid() const {
       int fish = 0;
       for (const auto& r : rooms) {
@@ -267,110 +300,92 @@ namespace {
     }
   };
 
-  struct HeapComparator {
-    bool operator()(const MapState& lhs, const MapState& rhs) {
-      return lhs.energy > rhs.energy;
-    }
-  };
-
-  using StateList = std::vector<MapState>;
-
-  const auto HeapPop = [](auto& heap) {
-    auto s = heap.front();
-    std::pop_heap(heap.begin(), heap.end(), HeapComparator());
-    heap.pop_back();
-
-    return s;
-  };
-
-  const auto HeapPush = [](auto& heap, auto& s) {
-    heap.emplace_back(s);
-    std::push_heap(heap.begin(), heap.end(), HeapComparator());
-  };
-
-  int solve(MapState map) {
-    aoc::AutoTimer __t;
-    
-    // Maintain a heap of states
-    StateList sq;
-    sq.push_back(map);
-    std::make_heap(sq.begin(), sq.end(), HeapComparator());
-
-    // Maintain a list of visited states, so we can quickly eliminate them from our A*
-    int result = INT_MAX;
-    std::set<std::string> seen;
-
-    while (result == INT_MAX && !sq.empty()) {
-      auto s = HeapPop(sq);
-
-      const auto r = seen.emplace(s.hash());
-      if (!r.second) {
-        continue;
-      }
-
-      if (s.final()) {
-        result = s.energy;
-        break;
-      }
+  // States by the energy spent reaching them plus the least still to spend.
+  // A move can cost thousands, too many for Dial's buckets, so this is a
+  // radix heap.
+  using Queue = aoc::search::RadixHeap<aoc::search::Entry<MapState, int>>;
+
+  // Every move there is from s, with the energy it takes
+  template<typename Push>
+  void expand(const MapState& s, Push&& push) {
+    const auto push_move = [&](int from, int to) {
+      const auto next = s.move(from, to);
+      assert(next.valid());
+      push(next, next.energy - s.energy);
+    };
+
+    for (int i = 0; i < RoomCount; i++) {
+      if (!s.isRoomFinal(i)) {
+        const auto fish = s.rooms[i].front();
+        if (!IsFish(fish)) { continue; }
 
-      for (int i = 0; i < RoomCount; i++) {
-        if (!s.isRoomFinal(i)) {
-          const auto fish = s.rooms[i].front();
-          if (!IsFish(fish)) { continue; }
-
-          const auto t = TargetRoom(fish);
-          if (s.canMoveToRoom(i, t)) {
-            const auto next = s.move(s.doorways[i], s.doorways[t]);
-            assert(next.valid());
-            HeapPush(sq, next);
-          }
-        }
-
-        for (int j = 0; j < HallwaySize; j++) {
-          const auto fish = s.rooms[i].front();
-          if (!IsFish(fish)) {
-            continue;
-          }
-
-          const auto tf = s.hallway[j];
-          if (IsFish(tf)) {
-            continue;
-          }
-
-          if (s.canMoveToHall(i, j)) {
-            const auto next = s.move(s.doorways[i], j);
-            assert(next.valid());
-
-            HeapPush(sq, next);
-          }
+        const auto t = TargetRoom(fish);
+        if (s.canMoveToRoom(i, t)) {
+          push_move(s.doorways[i], s.doorways[t]);
         }
       }
 
       for (int j = 0; j < HallwaySize; j++) {
-        const char fish = s.hallway[j];
+        const auto fish = s.rooms[i].front();
         if (!IsFish(fish)) {
           continue;
         }
-        const auto t = TargetRoom(fish);
-        if (s.canMoveFromHall(j, t)) {
-          const auto next = s.move(j, s.doorways[t]);
-          assert(next.valid());
 
-          HeapPush(sq, next);
+        const auto tf = s.hallway[j];
+        if (IsFish(tf)) {
+          continue;
+        }
+
+        if (s.canMoveToHall(i, j)) {
+          push_move(s.doorways[i], j);
         }
       }
     }
 
+    for (int j = 0; j < HallwaySize; j++) {
+      const char fish = s.hallway[j];
+      if (!IsFish(fish)) {
+        continue;
+      }
+      const auto t = TargetRoom(fish);
+      if (s.canMoveFromHall(j, t)) {
+        push_move(j, s.doorways[t]);
+      }
+    }
+  }
+
+  int solve(MapState map) {
+    AOC_PROFILE_SCOPE("search");
+
+    // The queued states are freed all at once when the search is done, and
+    // the arena is reused by the next search on this thread
+    thread_local aoc::Arena arena;
+    arena.reset();
+    Queue sq(&arena);
+
+    // States already expanded, by their packed key
+    aoc::FlatHashSet<MapState::Key> seen;
+    const auto first_visit = [&seen](const MapState& s) { return seen.insert(s.key()).second; };
+
+    const auto energy = aoc::search::astar<int>(map, sq, first_visit,
+      [](const MapState& s, int, auto&& push) { expand(s, push); },
+      [](const MapState& s) { return s.final(); },
+      [](const MapState& s) { return s.lower_bound(); });
+    const int result = energy ? *energy : INT_MAX;
+
+    aoc::note_footprint("seen", seen);
+    aoc::note_footprint("queue", sq.size(), arena.capacity());
     return result;
   }
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
   MapState map;
-  std::string line;
+  std::string_view line;
   while (aoc::getline(f, line)) {
     constexpr int MinLineSize = 2 + (RoomCount * 2);
     constexpr int RoomOffset = 3;
@@ -384,15 +399,17 @@ int main(int argc, char** argv) {
     int room = 0;
     for (int i = RoomOffset; i < MinLineSize; i += 2) {
       map.rooms[room].push_back(line[i]);
-      map.doorways.push_back(i - 1);
+      map.doorways[room] = i - 1;
       room++;
     }
   }
   f.close();
 
+  t.phase("part1");
   const auto part1 = solve(map);
   aoc::print_result(1, part1);
 
+  t.phase("part2");
   map.insertFish({ "DD", "CB", "BA", "AC" });
 
   const auto part2 = solve(map);
@@ -401,3 +418,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(23, run);
@@ -1,8 +1,8 @@
 #include "aoc21/helpers.h"
+#include "aoc21/parse_cache.h"
 #include <map>
 #include <array>
 #include <queue>
-#include <set>
 #include <vector>
 
 namespace {
@@ -50,6 +50,27 @@ namespace {
   using Instruction = std::tuple<Opcode, Register, Parameter>;
   using Program = std::vector<Instruction>;
 
+  // An instruction as kept in the parse cache, tuples not being trivially
+  // copyable. Bump CacheVersion whenever this or the enums change.
+  class EncodedInstruction {
+  public:
+    int32_t op;
+    int32_t a;
+    int32_t b_register;
+    int32_t b_value;
+
+    static EncodedInstruction of(const Instruction& i) {
+      const auto& [op, a, b] = i;
+      return EncodedInstruction{ static_cast<int32_t>(op), static_cast<int32_t>(a), static_cast<int32_t>(b.first), b.second };
+    }
+
+    Instruction decode() const {
+      return Instruction(static_cast<Opcode>(op), static_cast<Register>(a), Parameter(static_cast<Register>(b_register), b_value));
+    }
+  };
+
+  constexpr uint32_t CacheVersion = 1;
+
   const auto parse_opcode = [](const auto sv) {
     const auto r = OpcodeMap.find(sv);
     if (r == OpcodeMap.end()) {
@@ -257,8 +278,12 @@ namespace {
 
   };
 
-  std::string result;
-  std::set<StateTuple> seen;
+  // Per thread, so a batch can solve several inputs at once; the table
+  // keeps its capacity from one input to the next. Part 1 leaves about 99M
+  // states in it: 3.2 GiB of 24 byte slots, where the std::set it replaced
+  // needed 64 bytes a node, 6.3 GB in all.
+  thread_local std::string result;
+  thread_local aoc::FlatHashSet<StateTuple> seen;
 
   bool solve(const Program& code, const StateTuple& regs, const std::vector<int>& range) {
     ALU alu(regs);
@@ -300,15 +325,29 @@ namespace {
   }
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
   Program code;
   ALU alu;
-  auto f = aoc::open_argv_1(argc, argv);
-  std::string s;
-  while (aoc::getline(f ,s)) {
-    ALU::parse_instruction(code, s);
+  auto f = aoc::map_argv_1(argc, argv);
+  aoc::ParseCache cache("Day24", CacheVersion, f.remaining());
+  if (cache.load()) {
+    for (const auto& e : cache.section<EncodedInstruction>(0)) {
+      code.push_back(e.decode());
+    }
+  } else {
+    std::string_view s;
+    while (aoc::getline(f ,s)) {
+      ALU::parse_instruction(code, s);
+    }
+    if (cache.enabled()) {
+      std::vector<EncodedInstruction> encoded;
+      std::transform(code.begin(), code.end(), std::back_inserter(encoded), EncodedInstruction::of);
+      cache.add(encoded);
+      cache.store();
+    }
   }
   f.close();
 
@@ -321,12 +360,22 @@ int main(int argc, char** argv) {
     dec_range.push_back(i);
   }
 
+  t.phase("part1");
+  // Left over from a previous run when benchmarking
+  result.clear();
+  seen.clear();
   solve(code, alu.get_state(), dec_range);
+  aoc::note_footprint("seen", seen);
   aoc::print_result(1, result);
+  t.phase("part2");
   result.clear();
   seen.clear();
   solve(code, alu.get_state(), inc_range);
+  aoc::note_footprint("seen", seen);
   aoc::print_result(2, result);
+  seen.clear();
 
   return 0;
-}
\ No newline at end of file
+}
+
+AOC_REGISTER_DAY(24, run);
@@ -1,54 +1,57 @@
 #include "aoc21/helpers.h"
+#include "aoc21/automaton.h"
 #include <thread>
 #include <vector>
-#include <queue>
 
 namespace {
-  using Row = std::vector<char>;
-  using Grid = std::vector<Row>;
-
-  const auto canMoveEast = [](const Grid& g, size_t x, size_t y) {
-    assert(y < g.size());
-    const auto& row = g[y];
-    assert(x < row.size());
-    const size_t next_x = (x + 1) % row.size();
+  // The sea floor wraps around east to west and south to north. One plane
+  // holds the east herd, the other the south herd.
+  constexpr size_t East = 0;
+  constexpr size_t South = 1;
+  using Grid = aoc::automaton::Automaton<2>;
+  using Window = aoc::automaton::Window<2>;
+  using Out = std::array<uint64_t*, 2>;
+
+  // Cells of word i with neither herd in them, dx, dy away
+  uint64_t vacant(const Window& w, int dx, int dy, size_t i) {
+    return ~(w.at(East, dx, dy, i) | w.at(South, dx, dy, i));
+  }
 
-    return (row[x] == '>' && row[next_x] == '.');
+  // The east herd moves into any free cell east of it
+  const auto move_east = [](const Window& w, const Out& out) {
+    uint64_t moved = 0;
+    for (size_t i = 0; i < w.words(); i++) {
+      const uint64_t east = w.at(East, 0, 0, i);
+      const uint64_t leaves = east & vacant(w, 1, 0, i);
+      out[East][i] = (east & ~leaves) | (w.at(East, -1, 0, i) & vacant(w, 0, 0, i));
+      out[South][i] = w.at(South, 0, 0, i);
+      moved += __builtin_popcountll(leaves & w.valid(i));
+    }
+    return moved;
   };
 
-  const auto canMoveSouth = [](const Grid& g, size_t x, size_t y) {
-    assert(y < g.size());
-    const auto& row = g[y];
-    assert(x < row.size());
-    const size_t next_y = (y + 1) % g.size();
-    const auto& next_row = g[next_y];
-
-    return (row[x] == 'v' && next_row[x] == '.');
+  // Then the south herd into any free cell south of it
+  const auto move_south = [](const Window& w, const Out& out) {
+    uint64_t moved = 0;
+    for (size_t i = 0; i < w.words(); i++) {
+      const uint64_t south = w.at(South, 0, 0, i);
+      const uint64_t leaves = south & vacant(w, 0, 1, i);
+      out[South][i] = (south & ~leaves) | (w.at(South, 0, -1, i) & vacant(w, 0, 0, i));
+      out[East][i] = w.at(East, 0, 0, i);
+      moved += __builtin_popcountll(leaves & w.valid(i));
+    }
+    return moved;
   };
 
-  const auto moveEast = [](Grid& g, size_t x, size_t y) {
-    assert(canMoveEast(g, x, y));
-
-    auto& row = g[y];
-    const size_t next_x = (x + 1) % row.size();
-    row[next_x] = row[x];
-    row[x] = '.';
-  };
-  const auto moveSouth = [](Grid& g, size_t x, size_t y) {
-    assert(canMoveSouth(g, x, y));
-
-    auto& row = g[y];
-    const size_t next_y = (y + 1) % g.size();
-    auto& next_row = g[next_y];
-    next_row[x] = row[x];
-    row[x] = '.';
-  };
+  // Cucumbers that moved in one step
+  uint64_t step(Grid& grid) {
+    return grid.step(move_east) + grid.step(move_south);
+  }
 
   std::ostream& operator<<(std::ostream& os, const Grid& g) {
-    for (size_t y = 0; y < g.size(); y++) {
-      const auto& row = g[y];
-      for (size_t x = 0; x < row.size(); x++) {
-        os << row[x];
+    for (size_t y = 0; y < g.height(); y++) {
+      for (size_t x = 0; x < g.width(); x++) {
+        os << (g.plane(East).get(x, y) ? '>' : g.plane(South).get(x, y) ? 'v' : '.');
       }
       os << std::endl;
     }
@@ -57,62 +60,40 @@ namespace {
   }
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
   const bool display = argc > 2 && argv[2][0] == '1';
 
-  std::string line;
-  Grid grid;
-  size_t width = 0;
+  std::vector<std::string_view> rows;
+  std::string_view line;
   while (aoc::getline(f, line)) {
-    grid.emplace_back();
-    auto& r = grid.back();
-    for (const auto& c: line) {
-      assert(c == '.' || c == '>' || c == 'v');
-      r.push_back(c);
-    }
-    if (width == 0) {
-      width = line.size();
+    if (!rows.empty() && line.size() != rows[0].size()) {
+      throw std::runtime_error("Invalid input");
     }
+    rows.push_back(line);
+  }
 
-    assert(r.size() == width);
+  Grid grid(rows.empty() ? 0 : rows[0].size(), rows.size(), aoc::automaton::Edges::Wrap);
+  for (size_t y = 0; y < rows.size(); y++) {
+    for (size_t x = 0; x < rows[y].size(); x++) {
+      const char c = rows[y][x];
+      assert(c == '.' || c == '>' || c == 'v');
+      grid.plane(East).set(x, y, c == '>');
+      grid.plane(South).set(x, y, c == 'v');
+    }
   }
   f.close();
 
-  const size_t height = grid.size();
-
+  t.phase("part1");
   size_t part1 = 0;
   bool didMove = false;
   if (display) { std::cout << aoc::cls; };
   do {
-    std::queue<std::pair<size_t, size_t>> moves;
-    for (size_t x = 0; x < width; x++) {
-      for (size_t y = 0; y < height; y++) {
-        if (canMoveEast(grid, x, y)) {
-          moves.emplace(std::make_pair(x, y));
-        }
-      }
-    }
-    didMove = !moves.empty();
-    while (!moves.empty()) {
-      moveEast(grid, moves.front().first, moves.front().second);
-      moves.pop();
-    }
-    for (size_t x = 0; x < width; x++) {
-      for (size_t y = 0; y < height; y++) {
-        if (canMoveSouth(grid, x, y)) {
-          moves.emplace(std::make_pair(x, y));
-        }
-      }
-    }
-    didMove |= !moves.empty();
-    while (!moves.empty()) {
-      moveSouth(grid, moves.front().first, moves.front().second);
-      moves.pop();
-    }
+    didMove = step(grid) > 0;
     if (display) {
       std::this_thread::sleep_for (std::chrono::milliseconds(10));
       std::cout << aoc::cls;
@@ -127,3 +108,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(25, run);
@@ -34,7 +34,7 @@ namespace {
   const auto count_frequency = [](const auto & l, size_t bit) {
     size_t f = 0;
     size_t c = 0;
-    for(const auto vb : l) {
+    for(const auto& vb : l) {
         f += vb[bit];
         c ++;
       }
@@ -42,8 +42,9 @@ namespace {
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
   auto in = aoc::open_argv_1(argc, argv);
 
@@ -90,6 +91,7 @@ int main(int argc, char** argv) {
     }
   }
 
+  t.phase("part1");
   size_t shift = 0;
   int gamma = 0;
   int epsilon = 0;
@@ -104,6 +106,7 @@ int main(int argc, char** argv) {
   DEBUG_PRINT("gamma: " << gamma << " epsilon: " << epsilon << " power: " << (gamma * epsilon));
   aoc::print_result(1, (gamma * epsilon));
 
+  t.phase("part2");
   std::list<std::vector<bool>> oxygen_list;
   std::list<std::vector<bool>> co2_list;
   for (const auto n : numbers) {
@@ -170,3 +173,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(3, run);
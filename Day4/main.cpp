@@ -1,4 +1,5 @@
 #include "aoc21/helpers.h"
+#include "aoc21/parse_cache.h"
 
 #include <vector>
 #include <list>
@@ -10,6 +11,115 @@ namespace {
   using Board = std::vector<Row>;
   using BoardList = std::list<Board>;
 
+  // The input flattened, which is also what the parse cache holds: the
+  // drawing order, every board number in reading order, the length of each
+  // row and the number of rows of each board. Bump CacheVersion whenever
+  // this changes.
+  class Parsed {
+  public:
+    std::vector<int> draws;
+    std::vector<int> numbers;
+    std::vector<uint32_t> row_sizes;
+    std::vector<uint32_t> board_rows;
+  };
+
+  constexpr uint32_t CacheVersion = 1;
+
+  Parsed parse(aoc::MappedInput& f) {
+    Parsed p;
+
+    // Boards end at blank lines, which aoc::getline() skips, so the lines
+    // are split off the mapping here
+    std::string_view rest = f.remaining();
+    f.consume(rest.size());
+    const auto next_line = [&rest](std::string_view& line) {
+      if (rest.empty()) {
+        return false;
+      }
+      const auto nl = rest.find('\n');
+      line = rest.substr(0, nl);
+      rest.remove_prefix(nl == std::string_view::npos ? rest.size() : nl + 1);
+      if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+      }
+      return true;
+    };
+
+    // Parse the drawing order
+    int num = 0;
+    std::string_view line;
+    next_line(line);
+    for (const char c : line) {
+      if (c == ',') {
+        p.draws.push_back(num);
+        num = 0;
+      } else if (c >= '0' && c <= '9') {
+        num *= 10;
+        num += (c - '0');
+      } else {
+        throw std::runtime_error("Invalid input");
+      }
+    }
+    p.draws.push_back(num);
+
+    // Parse the game boards
+    uint32_t rows = 0;
+    while (next_line(line)) {
+      if (line.empty() && rows) {
+        p.board_rows.push_back(rows);
+        rows = 0;
+      } else if (!line.empty()) {
+        const size_t first = p.numbers.size();
+        p.numbers.push_back(0);
+        bool in_num = false;
+
+        for (const char c : line) {
+          if (c == ' ') {
+            if (in_num) {
+              p.numbers.push_back(0);
+            }
+            in_num = false;
+          } else if (c >= '0' && c <= '9') {
+            in_num = true;
+            p.numbers.back() *= 10;
+            p.numbers.back() += (c - '0');
+          } else {
+            throw std::runtime_error("Invalid input");
+          }
+        }
+        p.row_sizes.push_back(static_cast<uint32_t>(p.numbers.size() - first));
+        rows++;
+      }
+    }
+
+    if (rows) {
+      p.board_rows.push_back(rows);
+    }
+    return p;
+  }
+
+  template<typename Numbers, typename Sizes>
+  BoardList make_boards(const Numbers& numbers, const Sizes& row_sizes, const Sizes& board_rows) {
+    BoardList boards;
+    size_t number = 0;
+    size_t row = 0;
+    for (const auto rows : board_rows) {
+      Board board;
+      for (size_t r = 0; r < rows; r++, row++) {
+        if (row >= row_sizes.size() || row_sizes[row] > numbers.size() - number) {
+          throw std::runtime_error("Invalid input");
+        }
+        Row squares;
+        for (size_t i = 0; i < row_sizes[row]; i++) {
+          squares.emplace_back(numbers[number++], false);
+        }
+        board.emplace_back(std::move(squares));
+      }
+      boards.emplace_back(std::move(board));
+    }
+    return boards;
+  }
+
   const auto IsBoardComplete = [](const Board& b) {
     // All visited in row
     for (const auto& row : b) {
@@ -77,62 +187,31 @@ namespace {
   }
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
-
-  // Parse the drawing order
-  std::vector<int>bingo_drawer;
-  int num = 0;
-  std::string line;
-  std::getline(f, line);
-  for (const char c : line) {
-    if (c == ',') {
-      bingo_drawer.push_back(num);
-      num = 0;
-    } else if (c >= '0' || c <= '9') {
-      num *= 10;
-      num += (c - '0');
-    }
-  }
-  bingo_drawer.push_back(num);
-
-  // Parse the game boards
+  auto f = aoc::map_argv_1(argc, argv);
+  aoc::ParseCache cache("Day4", CacheVersion, f.remaining());
+  std::vector<int> bingo_drawer;
   BoardList boards;
-  Board board;
-  while (f.good()) {
-    line.resize(0);
-    std::getline(f, line);
-    if (line.empty() && !board.empty()) {
-      boards.emplace_back(std::move(board));
-    } else if (!line.empty()) {
-      Row row;
-      row.emplace_back(0, false);
-      size_t pos = 0;
-      bool in_num = false;
-      
-      for (const char c : line) {
-        if (c == ' ') {
-          if (in_num) {
-            row.emplace_back(0, false);
-            pos++;
-          }
-          in_num = false;
-        } else if (c >= '0' || c <= '9') {
-          in_num = true;
-          row[pos].first *= 10;
-          row[pos].first += (c - '0');
-        }
-      }
-      board.emplace_back(std::move(row));
-    }
-  }
-
-  if (!board.empty()) {
-      boards.emplace_back(std::move(board));
+  if (cache.load()) {
+    const auto draws = cache.section<int>(0);
+    bingo_drawer.assign(draws.begin(), draws.end());
+    boards = make_boards(cache.section<int>(1), cache.section<uint32_t>(2), cache.section<uint32_t>(3));
+  } else {
+    auto p = parse(f);
+    cache.add(p.draws);
+    cache.add(p.numbers);
+    cache.add(p.row_sizes);
+    cache.add(p.board_rows);
+    cache.store();
+    bingo_drawer = std::move(p.draws);
+    boards = make_boards(p.numbers, p.row_sizes, p.board_rows);
   }
+  f.close();
 
+  t.phase("part1");
   // Play games
   bool has_won = false;
   for (const auto move : bingo_drawer) {
@@ -146,6 +225,7 @@ int main(int argc, char** argv) {
 
           aoc::print_result(1, (score * move));
           has_won = true;
+          t.phase("part2");
         }
         if (boards.size() == 1) {
           DEBUG(DisplayBoard(*it));
@@ -165,3 +245,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(4, run);
@@ -1,7 +1,6 @@
 #include "aoc21/helpers.h"
 #include <array>
 #include <numeric>
-#include <map>
 #include <numeric>
 
 /*
@@ -49,7 +48,8 @@ namespace {
 
 using Point = std::pair<int, int>;
 using PointPair = std::pair<Point, Point>;
-using Grid = std::map<Point, int>;
+// Vents by position, keyed by the packed point rather than the pair
+using Grid = aoc::FlatHashMap<aoc::PackedPoint2, int>;
 
 const auto ParsePointPair = [](const std::string& line) {
   std::array<int, 4>points;
@@ -92,7 +92,7 @@ const auto ParsePointPair = [](const std::string& line) {
 
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
 
   bool diaganols = false;
   Grid grid;
@@ -119,7 +119,7 @@ int main(int argc, char** argv) {
       if (!r.second) {
         r.first->second++;
       }
-      DEBUG(std::cout << r.first->first.first << "," << r.first->first.second << " -> " << r.first->second << std::endl);
+      DEBUG(std::cout << r.first->first.x() << "," << r.first->first.y() << " -> " << r.first->second << std::endl);
       if (cp.first != ep.first) {
         cp.first += x_step;
       }
@@ -137,8 +137,11 @@ int main(int argc, char** argv) {
   };
 
   aoc::AutoTimer t;
+  // Opened once, as stdin can only be read once
+  auto f = aoc::map_argv_1(argc, argv);
   for (int part = 0; part < 2; part++) {
-    auto f = aoc::open_argv_1(argc, argv);
+    t.phase(part == 0 ? "part1" : "part2");
+    f.rewind();
 
     std::string s;
 
@@ -160,3 +163,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(5, run);
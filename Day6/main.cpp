@@ -1,63 +1,88 @@
 #include "aoc21/helpers.h"
-#include <sstream>
 #include <array>
-#include <numeric>
-#include <vector>
 
-constexpr int MaxLifetime = 8;
-using FishCounts = std::array<int64_t, MaxLifetime + 1>;
+namespace {
+  constexpr int MaxLifetime = 8;
+  using FishCounts = std::array<int64_t, MaxLifetime + 1>;
 
-int main(int argc, char** argv) {
+  // Fish counted by days left on their timer. Rather than shifting every
+  // count down each day, the counts stay put and the index of timer 0 moves.
+  class School {
+  private:
+    FishCounts fish_{};
+    size_t head_ = 0;
+    int64_t count_ = 0;
+
+  public:
+    constexpr void add(int timer) {
+      if (timer < 0 || timer > MaxLifetime) {
+        throw std::runtime_error("Invalid input");
+      }
+      fish_[timer]++;
+      count_++;
+    }
+
+    constexpr void advance(int days) {
+      for (int day = 0; day < days; day++) {
+        // Fish at 0 go back to 6 and each has a child at 8, which is where
+        // timer 0 sits once head_ moves on
+        const int64_t recycled = fish_[head_];
+        head_ = (head_ + 1) % fish_.size();
+        fish_[(head_ + 6) % fish_.size()] += recycled;
+        count_ += recycled;
+      }
+    }
+
+    constexpr int64_t size() const {
+      return count_;
+    }
+  };
+
+  constexpr std::string_view Sample = "3,4,3,1,2";
+
+  constexpr School spawn(std::string_view input) {
+    School s;
+    aoc::ct::for_each_token(input, ',', [&s](std::string_view t) { s.add(aoc::ct::to_integer(t)); });
+    return s;
+  }
+
+  constexpr int64_t after(School s, int days) {
+    s.advance(days);
+    return s.size();
+  }
+
+  constexpr aoc::SampleAnswers SampleSolution{ after(spawn(Sample), 80), after(spawn(Sample), 256) };
+  static_assert(SampleSolution == aoc::SampleAnswers(5934, 26984457539));
+};
+
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  std::string input;
-  std::getline(f, input);
-  f.close();
-  
-  FishCounts fish { };
-  int64_t count = 0;
-
-  aoc::parse_as_integers(input, ',', [&fish, &count](int i) -> void {
-    assert(i <= MaxLifetime);
-    fish[i]++;
-    count++;
+  std::string_view input;
+  aoc::getline(f, input);
+
+  School school;
+  aoc::parse_as_integers(input, ',', [&school](int i) -> void {
+    school.add(i);
   });
+  f.close();
 
   constexpr int pt_1_end = 80;
   constexpr int pt_2_end = 256;
 
-  int head = 0;
-  int tail = MaxLifetime;
-  int rebirth_at = 6;
-
-  for (int generation = 0; generation < pt_1_end; generation++) {
-    const int64_t recycled = fish[head];
-    // shift left
-    head = (head + 1) % fish.size();
-    tail = (tail + 1) % fish.size();
-    rebirth_at = (rebirth_at + 1) % fish.size();
+  t.phase("part1");
+  school.advance(pt_1_end);
+  aoc::print_result(1, school.size());
 
-    fish[rebirth_at] += recycled;
-    count += recycled;
-    fish[tail] = recycled;
-  }
-  aoc::print_result(1, count);
-
-  for (int generation = pt_1_end; generation < pt_2_end; generation++) {
-    const int64_t recycled = fish[head];
-    // shift left
-    head = (head + 1) % fish.size();
-    tail = (tail + 1) % fish.size();
-    rebirth_at = (rebirth_at + 1) % fish.size();
-
-    fish[rebirth_at] += recycled;
-    count += recycled;
-    fish[tail] = recycled;
-  }
-  aoc::print_result(2, count);
+  t.phase("part2");
+  school.advance(pt_2_end - pt_1_end);
+  aoc::print_result(2, school.size());
 
   return 0;
 }
 
+AOC_REGISTER_DAY(6, run);
+AOC_REGISTER_SAMPLE_ANSWERS(6, SampleSolution);
@@ -1,53 +1,79 @@
 #include "aoc21/helpers.h"
-#include <numeric>
+#include <array>
 #include <vector>
-#include <cmath>
-#include <numeric>
 
-using InitialPositions = std::vector<int>;
+namespace {
+  using InitialPositions = std::vector<int>;
 
-int main(int argc, char** argv) {
+  constexpr int64_t distance(int a, int b) {
+    return a > b ? a - b : b - a;
+  }
+
+  // Fuel for part 1 (a step costs 1) and part 2 (the nth step costs n), for
+  // positions sorted ascending. Part 1 is cheapest at the median. Part 2 is
+  // cheapest within half a step of the mean, so only the two integers either
+  // side of it need trying.
+  constexpr aoc::SampleAnswers crab_fuel(const int* pos, size_t count) {
+    const size_t mid = count / 2;
+    const int median = (count % 2 == 0) ? ((pos[mid] + pos[mid - 1]) / 2) : pos[mid];
+
+    int64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+      sum += pos[i];
+    }
+    const int mean_down = static_cast<int>(sum / static_cast<int64_t>(count));
+    const int mean_up = static_cast<int>((sum + static_cast<int64_t>(count) - 1) / static_cast<int64_t>(count));
+
+    int64_t fuel = 0;
+    int64_t fuel_up = 0;
+    int64_t fuel_down = 0;
+    for (size_t i = 0; i < count; i++) {
+      fuel += distance(pos[i], median);
+      const int64_t up = distance(pos[i], mean_up);
+      fuel_up += (up * up + up) / 2;
+      const int64_t down = distance(pos[i], mean_down);
+      fuel_down += (down * down + down) / 2;
+    }
+    return { fuel, std::min(fuel_up, fuel_down) };
+  }
+
+  constexpr std::string_view Sample = "16,1,2,0,4,2,7,1,2,14";
+
+  constexpr aoc::SampleAnswers solve_sample() {
+    std::array<int, 16> pos{};
+    size_t count = 0;
+    aoc::ct::for_each_token(Sample, ',', [&](std::string_view t) { pos[count++] = aoc::ct::to_integer(t); });
+    aoc::ct::sort(pos.begin(), pos.begin() + count);
+    return crab_fuel(pos.data(), count);
+  }
+
+  constexpr aoc::SampleAnswers SampleSolution = solve_sample();
+  static_assert(SampleSolution == aoc::SampleAnswers(37, 168));
+};
+
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  std::string input;
-  std::getline(f, input);
-  f.close();
+  std::string_view input;
+  aoc::getline(f, input);
 
   InitialPositions pos { };
   aoc::parse_as_integers(input, ',', [&pos](int i) -> void { pos.push_back(i); });
+  f.close();
+  if (pos.empty()) {
+    throw std::runtime_error("Invalid input");
+  }
 
+  t.phase("solve");
   std::sort(pos.begin(), pos.end());
-  const size_t count = pos.size();
-  const size_t mid = count / 2;
-  const int median = (count % 2 == 0) ? ((pos[mid] + pos[mid - 1]) / 2) : pos[mid];
-  const int mean_up = ::ceil(static_cast<double>(std::accumulate(pos.begin(), pos.end(), 0)) / static_cast<double>(count));
-  const int mean_down = ::floor(static_cast<double>(std::accumulate(pos.begin(), pos.end(), 0)) / static_cast<double>(count));
-
-  size_t fuel = std::accumulate(pos.begin(), pos.end(), 0, [&median](size_t s, const auto& i) {
-    const int distance_to_median = (i > median) ? (i - median) : (median - i);
-    return s + distance_to_median;
-  });
-  DEBUG_PRINT(median << ", " << fuel);
-  aoc::print_result(1, fuel);
-
-  size_t fuel_up = std::accumulate(pos.begin(), pos.end(), 0, [&mean_up](size_t s, const auto& i) {
-    const int distance_to_mean = (i > mean_up) ? (i - mean_up) : (mean_up - i);
-    const size_t fuel_to_mean = (distance_to_mean * distance_to_mean + distance_to_mean) / 2;
-    return s + fuel_to_mean;
-  });
-  DEBUG_PRINT(mean_up << ", " << fuel_up);
-
-  size_t fuel_down = std::accumulate(pos.begin(), pos.end(), 0, [&mean_down](size_t s, const auto& i) {
-    const int distance_to_mean = (i > mean_down) ? (i - mean_down) : (mean_down - i);
-    const size_t fuel_to_mean = (distance_to_mean * distance_to_mean + distance_to_mean) / 2;
-    return s + fuel_to_mean;
-  });
-  DEBUG_PRINT(mean_down << ", " << fuel_down);
-
-  aoc::print_result(2, std::min(fuel_up, fuel_down));
+  const auto fuel = crab_fuel(pos.data(), pos.size());
+  aoc::print_results(fuel.first, fuel.second);
 
   return 0;
 }
 
+AOC_REGISTER_DAY(7, run);
+AOC_REGISTER_SAMPLE_ANSWERS(7, SampleSolution);
@@ -1,7 +1,6 @@
 #include "aoc21/helpers.h"
+#include "aoc21/search.h"
 #include <vector>
-#include <queue>
-#include <utility>
 
 /*
 --- Day 9: Smoke Basin ---
@@ -68,133 +67,74 @@ What do you get if you multiply together the sizes of the three largest basins?
 */
 
 namespace {
-  using Row = std::vector<int>;
-  using HeightMap = std::vector<Row>;
-  using VisitedRow = std::vector<bool>;
-  using VisitedMap = std::vector<VisitedRow>;
-
-  using Point = std::pair<int, int>;
-  using PointQueue = std::queue<Point>;
-
-  const auto ParseRow = [](const auto& line) {
-    Row r;
-
-    // We know how big the row will be
-    r.reserve(line.size() + 2);
-    r.push_back(9);
-
-    for (const auto c : line) {
-      switch (c) {
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-          r.push_back(c - '0');
-          break;
-        default:
-          break;
-      }
-    }
-    r.push_back(9);
+  // Padded with 9s, which are never part of a basin
+  using HeightMap = aoc::Grid2D<int>;
 
-    return r;
+  const auto ParseHeight = [](const char c) {
+    if (c < '0' || c > '9') {
+      throw std::runtime_error("Invalid input");
+    }
+    return c - '0';
   };
 
-  // Flood fill a basin, and return its size
-  const auto FillBasin = [](const HeightMap& map, size_t x, size_t y, VisitedMap& done) {
-    size_t size = 0;
-
-    PointQueue q;
-    q.emplace(y, x);
-    while (!q.empty()) {
-      const auto p = q.front(); q.pop();
-
-      if (done[p.first][p.second]) {
-        continue;
-      }
-
-      done[p.first][p.second] = true;
-
-      const auto height = map[p.first][p.second];
-      if (height == 9) {
-        continue;
+  // Flood fill a basin, and return its size. The 9s around it are never
+  // queued, so each basin only visits its own cells.
+  const auto FillBasin = [](const HeightMap& map, size_t i, aoc::search::Bfs<size_t>& bfs, aoc::search::BitVisited& done) {
+    return bfs.run(i, done, [&map](const size_t p, auto&& push) {
+      for (const auto o : map.orthogonal()) {
+        if (map[p + o] != 9) {
+          push(p + o);
+        }
       }
-
-      if (!done[p.first - 1][p.second]) { q.emplace(p.first - 1, p.second); }
-      if (!done[p.first + 1][p.second]) { q.emplace(p.first + 1, p.second); }
-      if (!done[p.first][p.second - 1]) { q.emplace(p.first, p.second - 1); }
-      if (!done[p.first][p.second + 1]) { q.emplace(p.first, p.second + 1); }
-      size++;
-    }
-
-    return size;
+    });
   };
 
   // Determine if a point is a low point, that is, it is lower than all its neighbours
-  const auto IsLowPoint = [](const HeightMap& map, size_t x, size_t y) {
-    const auto height = map[y][x];
+  const auto IsLowPoint = [](const HeightMap& map, size_t i) {
+    const auto height = map[i];
 
     if (height == 9) {
       return false;
     }
 
-    assert(x > 0 && x < map[0].size() - 1);
-    assert(y > 0 && y < map.size() - 1);
-
-    return height < map[y][x - 1] && height < map[y][x + 1] &&
-           height < map[y - 1][x] && height < map[y + 1][x];
+    for (const auto o : map.orthogonal()) {
+      if (height >= map[i + o]) {
+        return false;
+      }
+    }
+    return true;
   };
 };
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
 
   aoc::AutoTimer t;
+  t.phase("parse");
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
-  HeightMap map;
-  VisitedMap done;
-  std::string line;
+  HeightMap map(0, 0, 9, 1);
+  std::string_view line;
   while (aoc::getline(f, line)) {
-    const auto r = ParseRow(line);
-    VisitedRow vr(r.size(), false);
-    assert (map.empty() || map[0].size() == r.size());
-    if (map.empty()) {
-      Row pad(r.size(), 9);
-      map.push_back(pad);
-
-      done.push_back(vr);
-      done.push_back(vr);
-    }
-
-    map.push_back(r);
-    done.push_back(vr);
+    map.push_row(line, ParseHeight);
   }
+  aoc::search::BitVisited done(map.cells());
+  aoc::search::Bfs<size_t> bfs;
 
-  Row pad(map[0].size(), 9);
-  map.push_back(pad);
-
+  t.phase("solve");
   size_t risk_level = 0;
   std::vector<size_t> basin_sizes;
-  for (size_t y = 1; y < map.size() - 1; y++) {
-    for (size_t x = 1; x < map[y].size() - 1; x++) {
-      if (IsLowPoint(map, x, y)) {
-        // Risk level is hieght + 1 of a low point
-        risk_level += map[y][x] + 1;
-
-        size_t size = FillBasin(map, x, y, done);
-        if (size > 0) {
-          basin_sizes.push_back(size);
-        }
+  map.for_each_index([&](const size_t i) {
+    if (IsLowPoint(map, i)) {
+      // Risk level is hieght + 1 of a low point
+      risk_level += map[i] + 1;
+
+      size_t size = FillBasin(map, i, bfs, done);
+      if (size > 0) {
+        basin_sizes.push_back(size);
       }
     }
-  }
+  });
 
   std::sort(basin_sizes.begin(), basin_sizes.end(), std::greater<>());
   assert(basin_sizes.size() >= 3);
@@ -204,3 +144,4 @@ int main(int argc, char** argv) {
   return 0;
 }
 
+AOC_REGISTER_DAY(9, run);
@@ -0,0 +1,506 @@
+#pragma once
+
+#include "aoc21/helpers.h"
+#include "aoc21/thread_pool.h"
+
+#include <array>
+#include <vector>
+
+namespace aoc {
+
+    // Cellular automata on bit planes. A cell's state is split over Planes
+    // bits, each kept in its own grid of one bit per cell, so a rule updates
+    // 64 cells at once with bitwise operations on words.
+    namespace automaton {
+
+        // What a rule sees past the edge of the grid: cells that are always
+        // 0, or the cells on the far side, as on a torus
+        enum class Edges {
+            Zero,
+            Wrap,
+        };
+
+        // Grid of one bit per cell. Cell x of a row is bit x % 64 of word
+        // x / 64. Each row has a guard word either side and there is an all
+        // zero row past the last, so that neighbours can be read without
+        // testing for the edges; seal() keeps the guards up to date.
+        class BitGrid {
+        private:
+            size_t width_;
+            size_t height_;
+            size_t words_;
+            size_t stride_;
+            std::vector<uint64_t> data_;
+
+        public:
+            BitGrid()
+                : width_(0)
+                , height_(0)
+                , words_(0)
+                , stride_(0)
+            { }
+
+            BitGrid(size_t width, size_t height)
+                : width_(width)
+                , height_(height)
+                , words_((width + 63) / 64)
+                , stride_(words_ + 2)
+                , data_(stride_ * (height + 1), 0)
+            { }
+
+            size_t width() const { return width_; }
+            size_t height() const { return height_; }
+
+            // Words of cells in a row, and from one row to the next
+            size_t words() const { return words_; }
+            size_t stride() const { return stride_; }
+
+            // Row height() is the all zero one
+            uint64_t* row(size_t y) { return &data_[y * stride_ + 1]; }
+            const uint64_t* row(size_t y) const { return &data_[y * stride_ + 1]; }
+
+            bool get(size_t x, size_t y) const {
+                return (row(y)[x >> 6] >> (x & 63)) & 1;
+            }
+
+            void set(size_t x, size_t y, bool on) {
+                uint64_t& w = row(y)[x >> 6];
+                const uint64_t bit = uint64_t(1) << (x & 63);
+                w = on ? w | bit : w & ~bit;
+            }
+
+            // Cells set
+            size_t count() const {
+                size_t n = 0;
+                for (size_t y = 0; y < height_; y++) {
+                    const uint64_t* r = row(y);
+                    for (size_t i = 0; i < words_; i++) {
+                        n += __builtin_popcountll(r[i] & valid(i));
+                    }
+                }
+                return n;
+            }
+
+            void clear() {
+                std::fill(data_.begin(), data_.end(), 0);
+            }
+
+            // The cells of word i of a row that are in the grid
+            uint64_t valid(size_t i) const {
+                const size_t tail = width_ & 63;
+                return i + 1 < words_ || tail == 0 ? ~uint64_t(0) : (uint64_t(1) << tail) - 1;
+            }
+
+            // Clears the bits past the end of row y, then for a torus copies
+            // the last cell into the guard before the row and the first into
+            // the bit after its end
+            void seal(size_t y, Edges edges) {
+                uint64_t* r = row(y);
+                r[words_ - 1] &= valid(words_ - 1);
+                if (edges == Edges::Wrap) {
+                    const size_t last = width_ - 1;
+                    const uint64_t first = r[0] & 1;
+                    r[-1] = ((r[last >> 6] >> (last & 63)) & 1) << 63;
+                    if (width_ & 63) {
+                        r[words_ - 1] |= first << (width_ & 63);
+                    } else {
+                        r[words_] = first;
+                    }
+                }
+            }
+
+            size_t memory() const {
+                return data_.capacity() * sizeof(uint64_t);
+            }
+        };
+
+        // Bit sliced counts: bit x of word b is bit b of the count for cell x
+        template<size_t Bits>
+        using Count = std::array<uint64_t, Bits>;
+
+        inline __attribute__((always_inline)) void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry) {
+            const uint64_t ab = a ^ b;
+            sum = ab ^ c;
+            carry = (a & b) | (ab & c);
+        }
+
+        // For each cell, how many of the 8 words have it set
+        inline __attribute__((always_inline)) Count<4> count8(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e, uint64_t f, uint64_t g, uint64_t h) {
+            uint64_t s1, c1, s2, c2, ones, k1, twos, k2;
+            full_add(a, b, c, s1, c1);
+            full_add(d, e, f, s2, c2);
+            const uint64_t s3 = g ^ h;
+            const uint64_t c3 = g & h;
+            full_add(s1, s2, s3, ones, k1);
+            full_add(c1, c2, c3, twos, k2);
+            const uint64_t k3 = twos & k1;
+            return { ones, twos ^ k1, k2 ^ k3, k2 & k3 };
+        }
+
+        // a + b, dropping any carry out of the top bit of a
+        template<size_t A, size_t B>
+        inline __attribute__((always_inline)) Count<A> add(const Count<A>& a, const Count<B>& b) {
+            static_assert(B <= A, "The sum is kept to the bits of the wider count");
+            Count<A> sum;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < A; i++) {
+                full_add(a[i], i < B ? b[i] : 0, carry, sum[i], carry);
+            }
+            return sum;
+        }
+
+        template<size_t Planes>
+        class Automaton;
+
+        // One row of the current generation as a rule sees it: the words of
+        // every plane in the rows above, at and below it, shifted so that
+        // bit x of at(plane, dx, dy, i) is the cell dx, dy away from cell x
+        // of word i. Bits past the end of the row are left undefined.
+        template<size_t Planes>
+        class Window {
+        public:
+            using Bases = std::array<const uint64_t*, Planes>;
+
+        private:
+            friend class Automaton<Planes>;
+
+            const Bases& bases_;
+            std::array<size_t, 3> offsets_;
+            size_t y_;
+            size_t height_;
+            size_t words_;
+            size_t stride_;
+            uint64_t tail_;
+            bool wrap_;
+
+            // bases holds row 0 of each plane, all of them shaped like grid
+            Window(const Bases& bases, const BitGrid& grid, Edges edges)
+                : bases_(bases)
+                , offsets_()
+                , y_(0)
+                , height_(grid.height())
+                , words_(grid.words())
+                , stride_(grid.stride())
+                , tail_(grid.valid(grid.words() - 1))
+                , wrap_(edges == Edges::Wrap)
+            { }
+
+            // Past the edge is the zero row unless the grid wraps
+            void seek(size_t y) {
+                y_ = y;
+                offsets_[0] = (y > 0 ? y - 1 : wrap_ ? height_ - 1 : height_) * stride_;
+                offsets_[1] = y * stride_;
+                offsets_[2] = (y + 1 < height_ ? y + 1 : wrap_ ? 0 : height_) * stride_;
+            }
+
+        public:
+            size_t y() const { return y_; }
+            size_t words() const { return words_; }
+
+            uint64_t valid(size_t i) const {
+                return i + 1 < words_ ? ~uint64_t(0) : tail_;
+            }
+
+            // The row dy away of a plane, for rules that read it whole; its
+            // guard words are at -1 and words()
+            const uint64_t* row(size_t plane, int dy) const {
+                return bases_[plane] + offsets_[dy + 1];
+            }
+
+            __attribute__((always_inline)) uint64_t at(size_t plane, int dx, int dy, size_t i) const {
+                const uint64_t* r = row(plane, dy);
+                if (dx < 0) {
+                    return (r[i] << 1) | (r[i - 1] >> 63);
+                }
+                if (dx > 0) {
+                    return (r[i] >> 1) | (r[i + 1] << 63);
+                }
+                return r[i];
+            }
+
+            // For each cell, how many of its 8 neighbours have the plane set
+            __attribute__((always_inline)) Count<4> neighbours(size_t plane, size_t i) const {
+                return count8(
+                    at(plane, -1, -1, i), at(plane, 0, -1, i), at(plane, 1, -1, i),
+                    at(plane, -1, 0, i), at(plane, 1, 0, i),
+                    at(plane, -1, 1, i), at(plane, 0, 1, i), at(plane, 1, 1, i));
+            }
+        };
+
+        // A grid of cells with Planes bits of state each, double buffered.
+        // A step builds the next generation a row at a time with
+        //
+        //     uint64_t rule(const Window<Planes>& in, const std::array<uint64_t*, Planes>& out)
+        //
+        // which writes every word of every plane of the row to out and
+        // returns a count of the day's choosing, summed over the grid; it
+        // should count only the cells in in.valid(i). Bands of rows run on
+        // the shared pool, so rules must not write anything else.
+        template<size_t Planes>
+        class Automaton {
+        public:
+            using Bases = typename Window<Planes>::Bases;
+            using Targets = std::array<uint64_t*, Planes>;
+
+            // Words a band of rows should have, to be worth a task
+            static constexpr size_t BandWords = 2048;
+
+        private:
+            // What a pass over some rows did
+            class Swept {
+            public:
+                uint64_t count = 0;
+                uint64_t rows = 0;
+            };
+
+            // The current generation and the one being built; a step flips
+            // current_ rather than swapping them
+            std::array<std::array<BitGrid, Planes>, 2> buffers_;
+            size_t current_;
+            Edges edges_;
+            // Set when plane() hands out the current generation to change,
+            // whose guards then need sealing before the next step
+            bool edited_;
+            uint64_t stepped_;
+            // The phase's count for the throughput report, looked up once as
+            // thread_local lookups cost more than a small grid's step
+            uint64_t* noted_;
+            // Rows settle() has yet to sweep
+            std::vector<uint8_t> dirty_;
+
+        public:
+            Automaton(size_t width, size_t height, Edges edges = Edges::Zero)
+                : current_(0)
+                , edges_(edges)
+                , edited_(false)
+                , stepped_(0)
+                , noted_(&Throughput::cells())
+            {
+                for (auto& planes : buffers_) {
+                    for (auto& g : planes) {
+                        g = BitGrid(width, height);
+                    }
+                }
+            }
+
+            size_t width() const { return buffers_[0][0].width(); }
+            size_t height() const { return buffers_[0][0].height(); }
+
+            // The current generation
+            BitGrid& plane(size_t p) {
+                edited_ = true;
+                return buffers_[current_][p];
+            }
+            const BitGrid& plane(size_t p) const { return buffers_[current_][p]; }
+
+            // Cells updated by every step and settle() so far
+            uint64_t stepped() const {
+                return stepped_;
+            }
+
+            template<typename Rule>
+            uint64_t step(Rule&& rule) {
+                if (empty()) {
+                    return 0;
+                }
+                seal();
+                const isa::Level level = isa::selected();
+                const size_t band = std::max<size_t>(1, BandWords / buffers_[0][0].words());
+                const size_t bands = (height() + band - 1) / band;
+                const Bases from = bases(buffers_[current_]);
+                auto& to = buffers_[current_ ^ 1];
+                const auto rows = [&](size_t b) {
+                    return apply(level, rule, from, to, b * band, std::min(height(), (b + 1) * band), false, nullptr).count;
+                };
+                // Small grids, stepped many times, skip the pool altogether
+                const uint64_t total = bands == 1 ? rows(0) :
+                    parallel_reduce(0, bands, uint64_t(0), rows, [](uint64_t a, uint64_t b) { return a + b; }, 1);
+
+                current_ ^= 1;
+                updated(height());
+                return total;
+            }
+
+            // Applies a rule that only ever sets cells, such as a cascade or
+            // a flood fill, in place until it sets no more, and returns the
+            // sum of its counts, which must be the cells it set. out is then
+            // the row in is looking at, so the rule need only write the words
+            // it changes.
+            //
+            // Each row sees the rows swept before it already updated, and
+            // sweeps go down the grid and back up in turn, so this takes far
+            // fewer passes than step() would take steps. Only rows next to
+            // one that changed are swept again. Bands run on the pool, the
+            // even ones and then the odd ones, so no two neighbouring bands
+            // are ever swept at once.
+            template<typename Rule>
+            uint64_t settle(Rule&& rule) {
+                if (empty()) {
+                    return 0;
+                }
+                seal();
+                const isa::Level level = isa::selected();
+                // At least two rows to a band, so two bands running at once
+                // never mark the same row between them. The last band takes
+                // the rows left over. On a torus the first and last bands
+                // touch, so they must not both be even.
+                const size_t band = std::max<size_t>(2, BandWords / buffers_[0][0].words());
+                size_t bands = std::max<size_t>(1, height() / band);
+                if (edges_ == Edges::Wrap && bands > 1 && bands % 2) {
+                    bands--;
+                }
+                dirty_.assign(height(), 1);
+                auto& cells = buffers_[current_];
+                const Bases from = bases(cells);
+                bool upwards = false;
+                const auto sweep = [&](size_t b) {
+                    const size_t lo = b * band;
+                    const size_t hi = b + 1 == bands ? height() : lo + band;
+                    return apply(level, rule, from, cells, lo, hi, upwards, dirty_.data());
+                };
+                const auto sum = [](const Swept& a, const Swept& b) { return Swept{ a.count + b.count, a.rows + b.rows }; };
+
+                uint64_t total = 0;
+                while (true) {
+                    Swept swept;
+                    if (bands == 1) {
+                        swept = sweep(0);
+                    } else {
+                        swept = parallel_reduce(0, (bands + 1) / 2, Swept(), [&](size_t k) { return sweep(2 * k); }, sum, 1);
+                        swept = sum(swept, parallel_reduce(0, bands / 2, Swept(), [&](size_t k) { return sweep(2 * k + 1); }, sum, 1));
+                    }
+                    if (!swept.rows) {
+                        return total;
+                    }
+                    total += swept.count;
+                    updated(swept.rows);
+                    upwards = !upwards;
+                }
+            }
+
+            size_t memory() const {
+                return 2 * Planes * buffers_[0][0].memory();
+            }
+
+        private:
+            bool empty() const {
+                return width() == 0 || height() == 0;
+            }
+
+            // Seals the current generation after the day changed it
+            void seal() {
+                if (!edited_) {
+                    return;
+                }
+                for (auto& g : buffers_[current_]) {
+                    for (size_t y = 0; y < height(); y++) {
+                        g.seal(y, edges_);
+                    }
+                }
+                edited_ = false;
+            }
+
+            static Bases bases(const std::array<BitGrid, Planes>& planes) {
+                Bases b;
+                for (size_t p = 0; p < Planes; p++) {
+                    b[p] = planes[p].row(0);
+                }
+                return b;
+            }
+
+            // Runs rule over rows [lo, hi) of from into the same rows of to,
+            // bottom up if upwards. Given dirty, only over the rows marked
+            // there, marking the rows either side of any the rule changed.
+            // The rule is flattened into a copy of the loop built for the
+            // level, where its popcounts are one instruction and its word
+            // loops may be vectorised. GCC's flatten skips functions it has
+            // already cloned, which can leave the rule or its helpers as
+            // calls, so Window's accessors and the counting helpers are
+            // always_inline.
+            template<typename Rule>
+            Swept apply(isa::Level level, Rule& rule, const Bases& from, std::array<BitGrid, Planes>& to, size_t lo, size_t hi, bool upwards, uint8_t* dirty) const {
+#if defined(AOC_ISA_X86)
+                if (level >= isa::Level::AVX2) {
+                    return apply_avx2(rule, from, to, lo, hi, upwards, dirty);
+                }
+                if (level >= isa::Level::SSE42) {
+                    return apply_sse42(rule, from, to, lo, hi, upwards, dirty);
+                }
+#endif
+                return apply_rows(rule, from, to, lo, hi, upwards, dirty);
+            }
+
+#if defined(AOC_ISA_X86)
+            template<typename Rule>
+            AOC_TARGET("sse4.2,popcnt") __attribute__((flatten)) Swept apply_sse42(Rule& rule, const Bases& from, std::array<BitGrid, Planes>& to, size_t lo, size_t hi, bool upwards, uint8_t* dirty) const {
+                return apply_rows(rule, from, to, lo, hi, upwards, dirty);
+            }
+
+            template<typename Rule>
+            AOC_TARGET("avx2,popcnt") __attribute__((flatten)) Swept apply_avx2(Rule& rule, const Bases& from, std::array<BitGrid, Planes>& to, size_t lo, size_t hi, bool upwards, uint8_t* dirty) const {
+                return apply_rows(rule, from, to, lo, hi, upwards, dirty);
+            }
+#endif
+
+            template<typename Rule>
+            __attribute__((always_inline)) Swept apply_rows(Rule& rule, const Bases& from, std::array<BitGrid, Planes>& to, size_t lo, size_t hi, bool upwards, uint8_t* dirty) const {
+                const size_t height = this->height();
+                const bool wrap = edges_ == Edges::Wrap;
+                // Every plane is shaped alike, so one offset finds a row in
+                // all of them, and only a torus needs more of seal() than
+                // clearing the bits past the end
+                const size_t words = to[0].words();
+                const size_t stride = to[0].stride();
+                const uint64_t tail = to[0].valid(words - 1);
+                Targets rows;
+                for (size_t p = 0; p < Planes; p++) {
+                    rows[p] = to[p].row(0);
+                }
+                Window<Planes> in(from, to[0], edges_);
+                Swept swept;
+                for (size_t k = lo; k < hi; k++) {
+                    const size_t y = upwards ? hi - 1 - (k - lo) : k;
+                    if (dirty) {
+                        if (!dirty[y]) {
+                            continue;
+                        }
+                        dirty[y] = 0;
+                    }
+                    Targets out;
+                    for (size_t p = 0; p < Planes; p++) {
+                        out[p] = rows[p] + y * stride;
+                    }
+                    in.seek(y);
+                    const uint64_t n = rule(static_cast<const Window<Planes>&>(in), static_cast<const Targets&>(out));
+                    if (wrap) {
+                        for (auto& g : to) {
+                            g.seal(y, edges_);
+                        }
+                    } else {
+                        for (size_t p = 0; p < Planes; p++) {
+                            out[p][words - 1] &= tail;
+                        }
+                    }
+                    if (dirty && n) {
+                        if (y > 0 || wrap) {
+                            dirty[y > 0 ? y - 1 : height - 1] = 1;
+                        }
+                        if (y + 1 < height || wrap) {
+                            dirty[y + 1 < height ? y + 1 : 0] = 1;
+                        }
+                    }
+                    swept.count += n;
+                    swept.rows++;
+                }
+                return swept;
+            }
+
+            // Counts rows updated, for stepped() and the report
+            void updated(uint64_t rows) {
+                const uint64_t cells = static_cast<uint64_t>(width()) * rows;
+                stepped_ += cells;
+                *noted_ += cells;
+            }
+        };
+    };
+};
@@ -0,0 +1,538 @@
+#pragma once
+
+#include "aoc21/helpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <vector>
+
+namespace aoc {
+
+    // Order statistics over one phase's samples, in seconds
+    class Summary {
+    public:
+        size_t count;
+        double min;
+        double median;
+        double p90;
+        double p99;
+        double mean;
+        double stddev;
+
+        explicit Summary(std::vector<double> samples)
+            : count(samples.size())
+            , min(0)
+            , median(0)
+            , p90(0)
+            , p99(0)
+            , mean(0)
+            , stddev(0)
+        {
+            if (samples.empty()) {
+                return;
+            }
+
+            std::sort(samples.begin(), samples.end());
+            min = samples.front();
+            median = percentile(samples, 0.5);
+            p90 = percentile(samples, 0.9);
+            p99 = percentile(samples, 0.99);
+            mean = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+            if (count > 1) {
+                const double sq = std::accumulate(samples.begin(), samples.end(), 0.0, [this](double s, double v) {
+                    return s + (v - mean) * (v - mean);
+                });
+                stddev = std::sqrt(sq / (count - 1));
+            }
+        }
+
+    private:
+        // Nearest rank on sorted samples
+        static double percentile(const std::vector<double>& sorted, double p) {
+            const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+            return sorted[std::max<size_t>(rank, 1) - 1];
+        }
+    };
+
+    // Samples for every phase a day reported, in the order the phases first ran
+    class PhaseSamples {
+    public:
+        std::vector<std::pair<std::string, std::vector<double>>> phases;
+
+        void add(const std::string& name, double seconds) {
+            auto it = std::find_if(phases.begin(), phases.end(), [&name](const auto& p) { return p.first == name; });
+            if (it == phases.end()) {
+                phases.emplace_back(name, std::vector<double>());
+                it = phases.end() - 1;
+            }
+            it->second.push_back(seconds);
+        }
+
+        // One iteration's phases; a phase entered more than once counts as one sample
+        void add(const PhaseTimes& times) {
+            PhaseSamples iteration;
+            for (const auto& [name, seconds] : times) {
+                auto it = std::find_if(iteration.phases.begin(), iteration.phases.end(), [&name](const auto& p) { return p.first == name; });
+                if (it == iteration.phases.end()) {
+                    iteration.add(name, seconds);
+                } else {
+                    it->second.back() += seconds;
+                }
+            }
+            for (const auto& [name, s] : iteration.phases) {
+                add(name, s.back());
+            }
+        }
+
+        // Samples from further runs of the same day
+        void merge(const PhaseSamples& other) {
+            for (const auto& [name, samples] : other.phases) {
+                for (const double seconds : samples) {
+                    add(name, seconds);
+                }
+            }
+        }
+    };
+
+    class BenchResult {
+    public:
+        int day;
+        std::string input;
+        size_t warmup;
+        PhaseSamples samples;
+        std::string output;
+        int rc;
+
+        BenchResult(int d, std::string in, size_t w)
+            : day(d)
+            , input(std::move(in))
+            , warmup(w)
+            , rc(0)
+        { }
+    };
+
+    inline void print_bench_report(std::ostream& os, const BenchResult& r) {
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+
+        const size_t iterations = r.samples.phases.empty() ? 0 : r.samples.phases.back().second.size();
+        os << "Benchmark Day" << r.day << ": " << iterations << " iterations, " << r.warmup << " warm-up (sec)" << std::endl;
+        os << std::left << std::setw(10) << "phase";
+        for (const auto* col : { "min", "median", "p90", "p99", "stddev" }) {
+            os << std::right << ' ' << std::setw(12) << col;
+        }
+        os << std::endl;
+
+        os << std::fixed << std::setprecision(9);
+        for (const auto& [name, samples] : r.samples.phases) {
+            const Summary s(samples);
+            os << std::left << std::setw(10) << name << std::right;
+            for (const double v : { s.min, s.median, s.p90, s.p99, s.stddev }) {
+                os << ' ' << std::setw(12) << v;
+            }
+            os << std::endl;
+        }
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    inline std::string json_escape(const std::string_view s) {
+        std::string out;
+        out.reserve(s.size() + 2);
+        for (const char c : s) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buf[8];
+                        ::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                        out += buf;
+                    } else {
+                        out.append(&c, 1);
+                    }
+                    break;
+            }
+        }
+        return out;
+    }
+
+    // A day's output without its timing, throughput and memory lines, i.e.
+    // just the answers
+    inline std::string answers(std::string_view output) {
+        std::string out;
+        std::string_view line;
+        while (!output.empty()) {
+            const auto eol = output.find('\n');
+            line = output.substr(0, eol);
+            output.remove_prefix(eol == std::string_view::npos ? output.size() : eol + 1);
+            if (line.substr(0, 7) != "Elapsed" && line.substr(0, 10) != "Throughput" && line.substr(0, 6) != "Memory") {
+                out.append(line);
+                out += '\n';
+            }
+        }
+        return out;
+    }
+
+    // Seconds for a fixed sort heavy workload, best of nine. Stored with a
+    // baseline so it can be scaled to the speed of the machine checking it.
+    inline double calibrate() {
+        double best = std::numeric_limits<double>::infinity();
+        std::vector<uint32_t> v(1 << 18);
+        for (int rep = 0; rep < 9; rep++) {
+            uint32_t x = 2463534242u;
+            for (auto& e : v) {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                e = x;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            std::sort(v.begin(), v.end());
+            volatile uint32_t sink = v[v.size() / 2];
+            (void)sink;
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // Just enough JSON to read back what write_bench_json writes
+    class JsonValue {
+    public:
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0;
+        std::string string;
+        std::vector<JsonValue> array;
+        std::vector<std::pair<std::string, JsonValue>> object;
+
+        const JsonValue* find(std::string_view key) const {
+            for (const auto& [k, v] : object) {
+                if (k == key) {
+                    return &v;
+                }
+            }
+            return nullptr;
+        }
+
+        static JsonValue parse(std::string_view text) {
+            size_t pos = 0;
+            JsonValue v = parse_value(text, pos);
+            skip_space(text, pos);
+            if (pos != text.size()) {
+                throw std::runtime_error("Trailing characters in JSON");
+            }
+            return v;
+        }
+
+    private:
+        static void skip_space(std::string_view text, size_t& pos) {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+                pos++;
+            }
+        }
+
+        static void expect(std::string_view text, size_t& pos, char c) {
+            skip_space(text, pos);
+            if (pos >= text.size() || text[pos] != c) {
+                throw std::runtime_error(std::string("Expected '") + c + "' in JSON at offset " + std::to_string(pos));
+            }
+            pos++;
+        }
+
+        static std::string parse_string(std::string_view text, size_t& pos) {
+            expect(text, pos, '"');
+            std::string out;
+            while (pos < text.size() && text[pos] != '"') {
+                char c = text[pos++];
+                if (c == '\\' && pos < text.size()) {
+                    c = text[pos++];
+                    switch (c) {
+                        case 'n': c = '\n'; break;
+                        case 'r': c = '\r'; break;
+                        case 't': c = '\t'; break;
+                        case 'u':
+                            if (pos + 4 > text.size()) {
+                                throw std::runtime_error("Bad escape in JSON");
+                            }
+                            // Only ever control characters here
+                            c = static_cast<char>(std::stoi(std::string(text.substr(pos, 4)), nullptr, 16));
+                            pos += 4;
+                            break;
+                        default: break;
+                    }
+                }
+                out += c;
+            }
+            expect(text, pos, '"');
+            return out;
+        }
+
+        static JsonValue parse_value(std::string_view text, size_t& pos) {
+            skip_space(text, pos);
+            if (pos >= text.size()) {
+                throw std::runtime_error("Unexpected end of JSON");
+            }
+
+            JsonValue v;
+            const char c = text[pos];
+            if (c == '{') {
+                v.type = Type::Object;
+                pos++;
+                skip_space(text, pos);
+                if (pos < text.size() && text[pos] == '}') {
+                    pos++;
+                    return v;
+                }
+                do {
+                    std::string key = parse_string(text, pos);
+                    expect(text, pos, ':');
+                    v.object.emplace_back(std::move(key), parse_value(text, pos));
+                    skip_space(text, pos);
+                } while (pos < text.size() && text[pos] == ',' && ++pos);
+                expect(text, pos, '}');
+            } else if (c == '[') {
+                v.type = Type::Array;
+                pos++;
+                skip_space(text, pos);
+                if (pos < text.size() && text[pos] == ']') {
+                    pos++;
+                    return v;
+                }
+                do {
+                    v.array.push_back(parse_value(text, pos));
+                    skip_space(text, pos);
+                } while (pos < text.size() && text[pos] == ',' && ++pos);
+                expect(text, pos, ']');
+            } else if (c == '"') {
+                v.type = Type::String;
+                v.string = parse_string(text, pos);
+            } else if (text.substr(pos, 4) == "true" || text.substr(pos, 5) == "false") {
+                v.type = Type::Bool;
+                v.boolean = c == 't';
+                pos += v.boolean ? 4 : 5;
+            } else if (text.substr(pos, 4) == "null") {
+                pos += 4;
+            } else {
+                v.type = Type::Number;
+                const std::string rest(text.substr(pos, 64));
+                size_t used = 0;
+                v.number = std::stod(rest, &used);
+                pos += used;
+            }
+            return v;
+        }
+    };
+
+    // Total times and answers per day from an earlier --json run
+    class Baseline {
+    public:
+        class Day {
+        public:
+            double median = 0;
+            std::string answers;
+        };
+
+        double calibration = 0;
+        std::map<int, Day> days;
+
+        static Baseline load(const std::string& path) {
+            std::ifstream f(path);
+            if (!f) {
+                throw std::runtime_error("Cannot read baseline " + path);
+            }
+            std::stringstream ss;
+            ss << f.rdbuf();
+            const JsonValue json = JsonValue::parse(ss.str());
+
+            Baseline b;
+            if (const auto* c = json.find("calibration")) {
+                b.calibration = c->number;
+            }
+            const auto* days = json.find("days");
+            if (!days) {
+                throw std::runtime_error("No days in baseline " + path);
+            }
+            for (const auto& d : days->array) {
+                const auto* day = d.find("day");
+                const auto* phases = d.find("phases");
+                const auto* out = d.find("answers");
+                if (!day || !phases || !out) {
+                    throw std::runtime_error("Incomplete day in baseline " + path);
+                }
+                Day& entry = b.days[static_cast<int>(day->number)];
+                entry.answers = out->string;
+                for (const auto& p : phases->array) {
+                    const auto* name = p.find("name");
+                    if (!name || name->string != "total") {
+                        continue;
+                    }
+                    if (const auto* median = p.find("median")) {
+                        entry.median = median->number;
+                    }
+                }
+            }
+            return b;
+        }
+    };
+
+    // Fails a day that gives different answers, or whose median run is
+    // more than threshold (a fraction) slower than the baseline's once
+    // scaled by machine speed. Slowdowns under min_delta seconds are noise.
+    // The runner times a day that looks slower once more before failing
+    // it, as the whole machine can slow down for a few seconds at a time.
+    class RegressionCheck {
+    public:
+        double threshold = 0.5;
+        double min_delta = 0.00002;
+        bool check_times = true;
+
+        // Machine speed relative to the one the baseline was recorded on
+        static double speed(const Baseline& baseline, double calibration) {
+            return (baseline.calibration > 0 && calibration > 0) ? calibration / baseline.calibration : 1.0;
+        }
+
+        class Timing {
+        public:
+            double median = 0;
+            double expected = 0;
+            double change = 0;
+            bool slower = false;
+        };
+
+        Timing timing(const BenchResult& r, const Baseline::Day& day, double speed) const {
+            Timing t;
+            for (const auto& [name, samples] : r.samples.phases) {
+                if (name == "total") {
+                    t.median = Summary(samples).median;
+                }
+            }
+            t.expected = day.median * speed;
+            t.change = t.expected > 0 ? t.median / t.expected - 1 : 0;
+            t.slower = check_times && t.change > threshold && t.median - t.expected > min_delta;
+            return t;
+        }
+
+        bool run(std::ostream& os, const std::vector<BenchResult>& results, const Baseline& baseline, double calibration) const {
+            const double speed = RegressionCheck::speed(baseline, calibration);
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+
+            os << "Baseline check: threshold " << std::fixed << std::setprecision(0) << threshold * 100 << "%, min delta " <<
+                std::setprecision(6) << min_delta << " s, machine speed factor " << std::setprecision(2) << speed << std::endl;
+            os << std::left << std::setw(8) << "day" << std::right << std::setw(14) << "median" << std::setw(14) << "baseline" <<
+                std::setw(10) << "change" << "  result" << std::endl;
+
+            bool ok = true;
+            for (const auto& r : results) {
+                const auto it = baseline.days.find(r.day);
+                os << std::left << std::setw(8) << ("Day" + std::to_string(r.day)) << std::right;
+                if (it == baseline.days.end()) {
+                    os << "  no baseline" << std::endl;
+                    continue;
+                }
+
+                const Timing t = timing(r, it->second, speed);
+                os << std::setprecision(6) << std::setw(14) << t.median << std::setw(14) << t.expected <<
+                    std::setprecision(1) << std::setw(9) << t.change * 100 << "%  ";
+
+                if (r.rc != 0) {
+                    os << "FAILED (rc " << r.rc << ")" << std::endl;
+                    ok = false;
+                } else if (answers(r.output) != it->second.answers) {
+                    os << "WRONG ANSWER" << std::endl;
+                    ok = false;
+                } else if (t.slower) {
+                    os << "SLOWER" << std::endl;
+                    ok = false;
+                } else {
+                    os << "ok" << std::endl;
+                }
+            }
+
+            os.flags(flags);
+            os.precision(precision);
+            return ok;
+        }
+    };
+
+    // Median total time per day against an earlier run of another build on
+    // the same machine, as a speedup; nothing is scaled and nothing fails
+    inline void print_comparison(std::ostream& os, const std::vector<BenchResult>& results, const Baseline& baseline) {
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+
+        os << std::left << std::setw(8) << "day" << std::right << std::setw(14) << "median" << std::setw(14) << "before" <<
+            std::setw(10) << "speedup" << std::endl;
+        double total = 0;
+        double total_before = 0;
+        for (const auto& r : results) {
+            const auto it = baseline.days.find(r.day);
+            if (it == baseline.days.end()) {
+                continue;
+            }
+            double median = 0;
+            for (const auto& [name, samples] : r.samples.phases) {
+                if (name == "total") {
+                    median = Summary(samples).median;
+                }
+            }
+            total += median;
+            total_before += it->second.median;
+            os << std::left << std::setw(8) << ("Day" + std::to_string(r.day)) << std::right << std::fixed <<
+                std::setprecision(6) << std::setw(14) << median << std::setw(14) << it->second.median <<
+                std::setprecision(2) << std::setw(9) << (median > 0 ? it->second.median / median : 0) << "x" << std::endl;
+        }
+        os << std::left << std::setw(8) << "all" << std::right << std::setprecision(6) << std::setw(14) << total <<
+            std::setw(14) << total_before << std::setprecision(2) << std::setw(9) << (total > 0 ? total_before / total : 0) <<
+            "x" << std::endl;
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    // Machine readable form of the reports, times in seconds. Doubles as a
+    // baseline for RegressionCheck.
+    inline void write_bench_json(std::ostream& os, const std::vector<BenchResult>& results, double calibration) {
+        os << std::setprecision(9);
+        os << "{" << std::endl;
+        os << "  \"unit\": \"s\"," << std::endl;
+        os << "  \"calibration\": " << calibration << "," << std::endl;
+        os << "  \"days\": [" << std::endl;
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& r = results[i];
+            os << "    {" << std::endl;
+            os << "      \"day\": " << r.day << "," << std::endl;
+            os << "      \"input\": \"" << json_escape(r.input) << "\"," << std::endl;
+            os << "      \"warmup\": " << r.warmup << "," << std::endl;
+            os << "      \"rc\": " << r.rc << "," << std::endl;
+            os << "      \"answers\": \"" << json_escape(answers(r.output)) << "\"," << std::endl;
+            os << "      \"phases\": [" << std::endl;
+            for (size_t j = 0; j < r.samples.phases.size(); j++) {
+                const auto& [name, samples] = r.samples.phases[j];
+                const Summary s(samples);
+                os << "        { \"name\": \"" << json_escape(name) << "\", \"iterations\": " << s.count <<
+                    ", \"min\": " << s.min << ", \"median\": " << s.median << ", \"p90\": " << s.p90 <<
+                    ", \"p99\": " << s.p99 << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev <<
+                    ", \"samples\": [";
+                for (size_t k = 0; k < samples.size(); k++) {
+                    os << (k ? ", " : "") << samples[k];
+                }
+                os << "] }" << (j + 1 < r.samples.phases.size() ? "," : "") << std::endl;
+            }
+            os << "      ]" << std::endl;
+            os << "    }" << (i + 1 < results.size() ? "," : "") << std::endl;
+        }
+        os << "  ]" << std::endl;
+        os << "}" << std::endl;
+    }
+
+};
@@ -8,7 +8,47 @@
 #include <chrono>
 #include <cassert>
 #include <functional>
+#include <map>
+#include <vector>
 #include <iomanip>
+#include <charconv>
+#include <cctype>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <ctime>
+#include <array>
+#include <tuple>
+#include <iterator>
+#include <new>
+#include <memory_resource>
+#include <atomic>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AOC_ISA_X86 1
+#include <immintrin.h>
+#endif
+
+// Compiles one function for a wider instruction set than the rest of the
+// build, for aoc::isa::Kernel to pick at run time
+#define AOC_TARGET(isa) __attribute__((target(isa)))
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 
 #ifndef NDEBUG
 #define DEBUG(x) do { \
@@ -18,10 +58,14 @@
 #define DEBUG(x)
 #endif
 
-#define DEBUG_PRINT(x) do { DEBUG(std::cout << __func__ << ":" << __LINE__ << ": " << x << std::endl); } while (0)
+#define DEBUG_PRINT(x) do { DEBUG(aoc::out() << __func__ << ":" << __LINE__ << ": " << x << std::endl); } while (0)
 
 #define STRING_CONSTANT(symbol, value) constexpr std::string_view symbol(value)
 
+// Register fn as the solver for day, see aoc21/runner.cpp for the main() that runs it
+#define AOC_REGISTER_DAY(day, fn) static const aoc::RegisterDay aoc_register_day_##day(day, fn)
+#define AOC_REGISTER_SAMPLE_ANSWERS(day, answers) static const aoc::RegisterSampleAnswers aoc_register_sample_answers_##day(day, answers)
+
 #ifndef INT_MIN
 #define INT_MIN std::numeric_limits<int>::min()
 #endif
@@ -32,19 +76,212 @@
 
 namespace aoc {
 
+    // Finalizer from splitmix64: every input bit affects every output bit,
+    // so masking off the low bits of the result makes a fine table index
+    constexpr uint64_t mix64(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
     using Point = std::pair<int, int>;
-    // Needed if we want to store a point in a hash
+    // Needed if we want to store a point in a hash. The second coordinate is
+    // masked so a negative one does not sign extend over the first.
     struct PointHash {
         std::size_t operator() (const Point& pair) const {
-            size_t v = pair.first;
+            uint64_t v = static_cast<uint32_t>(pair.first);
             v <<= 32;
-            v |= pair.second;
-            return v;
+            v |= static_cast<uint32_t>(pair.second);
+            return mix64(v);
+        }
+    };
+
+    namespace detail {
+        // The bits of x moved apart to every second (or third) bit, for
+        // interleaving coordinates into a Morton code
+        constexpr uint64_t spread2(uint64_t x) {
+            x &= 0xffffffffULL;
+            x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+            x = (x | (x << 8)) & 0x00ff00ff00ff00ffULL;
+            x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+            x = (x | (x << 2)) & 0x3333333333333333ULL;
+            x = (x | (x << 1)) & 0x5555555555555555ULL;
+            return x;
+        }
+
+        constexpr uint64_t spread3(uint64_t x) {
+            x &= 0x1fffffULL;
+            x = (x | (x << 32)) & 0x001f00000000ffffULL;
+            x = (x | (x << 16)) & 0x001f0000ff0000ffULL;
+            x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+            x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+            x = (x | (x << 2)) & 0x1249249249249249ULL;
+            return x;
+        }
+    };
+
+    // A signed 2D point as one 64 bit key: each coordinate biased by 2^31
+    // into an unsigned 32 bit field, x in the high half. Keys compare in x
+    // then y order, and aoc::Hash runs them through mix64.
+    class PackedPoint2 {
+    private:
+        static constexpr int64_t Bias = int64_t(1) << 31;
+
+    public:
+        uint64_t key;
+
+        constexpr PackedPoint2()
+            : PackedPoint2(0, 0)
+        { }
+
+        constexpr PackedPoint2(int32_t x, int32_t y)
+            : key((static_cast<uint64_t>(x + Bias) << 32) | static_cast<uint64_t>(y + Bias))
+        { }
+
+        constexpr PackedPoint2(const Point& p)
+            : PackedPoint2(p.first, p.second)
+        { }
+
+        constexpr int32_t x() const { return static_cast<int32_t>(static_cast<int64_t>(key >> 32) - Bias); }
+        constexpr int32_t y() const { return static_cast<int32_t>(static_cast<int64_t>(key & 0xffffffffULL) - Bias); }
+
+        constexpr Point point() const { return Point(x(), y()); }
+
+        // Z-order position: points near each other in both coordinates get
+        // near codes, for sorting cells into cache friendly order
+        constexpr uint64_t morton() const {
+            return (detail::spread2(key >> 32) << 1) | detail::spread2(key);
+        }
+
+        constexpr PackedPoint2 operator+(const PackedPoint2& o) const { return PackedPoint2(x() + o.x(), y() + o.y()); }
+        constexpr bool operator==(const PackedPoint2& o) const { return key == o.key; }
+        constexpr bool operator!=(const PackedPoint2& o) const { return key != o.key; }
+        constexpr bool operator<(const PackedPoint2& o) const { return key < o.key; }
+    };
+
+    // A signed 3D point as one 64 bit key: 21 bits a coordinate, biased by
+    // 2^20, so each must lie in [-2^20, 2^20). Keys compare in x, y, z order.
+    class PackedPoint3 {
+    private:
+        static constexpr int64_t Bias = int64_t(1) << 20;
+        static constexpr uint64_t Mask = (uint64_t(1) << 21) - 1;
+
+        static constexpr uint64_t field(int32_t v) {
+            assert(v >= -Bias && v < Bias);
+            return static_cast<uint64_t>(v + Bias);
+        }
+
+        static constexpr int32_t coordinate(uint64_t bits) {
+            return static_cast<int32_t>(static_cast<int64_t>(bits & Mask) - Bias);
+        }
+
+    public:
+        uint64_t key;
+
+        constexpr PackedPoint3()
+            : PackedPoint3(0, 0, 0)
+        { }
+
+        constexpr PackedPoint3(int32_t x, int32_t y, int32_t z)
+            : key((field(x) << 42) | (field(y) << 21) | field(z))
+        { }
+
+        constexpr int32_t x() const { return coordinate(key >> 42); }
+        constexpr int32_t y() const { return coordinate(key >> 21); }
+        constexpr int32_t z() const { return coordinate(key); }
+
+        constexpr uint64_t morton() const {
+            return (detail::spread3(key >> 42) << 2) | (detail::spread3(key >> 21) << 1) | detail::spread3(key);
+        }
+
+        constexpr PackedPoint3 operator+(const PackedPoint3& o) const { return PackedPoint3(x() + o.x(), y() + o.y(), z() + o.z()); }
+        constexpr bool operator==(const PackedPoint3& o) const { return key == o.key; }
+        constexpr bool operator!=(const PackedPoint3& o) const { return key != o.key; }
+        constexpr bool operator<(const PackedPoint3& o) const { return key < o.key; }
+    };
+
+    // Orders packed points along the Z-order curve rather than by x first
+    struct MortonLess {
+        template<typename P>
+        constexpr bool operator()(const P& a, const P& b) const {
+            return a.morton() < b.morton();
+        }
+    };
+
+    // A day's solver, called with the same arguments as its main() used to be
+    using SolveFunction = int (*)(int argc, char** argv);
+    using SolverRegistry = std::map<int, SolveFunction>;
+
+    // All days linked into this binary, by day number
+    inline SolverRegistry& solvers() {
+        static SolverRegistry registry;
+        return registry;
+    }
+
+    class RegisterDay {
+    public:
+        RegisterDay(int day, SolveFunction fn) {
+            const auto r = solvers().emplace(day, fn);
+            if (!r.second) {
+                throw std::logic_error("Day " + std::to_string(day) + " registered twice");
+            }
+        }
+    };
+
+    // Both answers to a day's sample, worked out at compile time by the day's
+    // constexpr solver and checked there with static_assert. aoc_all --sample
+    // compares the day's output against them.
+    using SampleAnswers = std::pair<int64_t, int64_t>;
+    using SampleAnswerTable = std::map<int, SampleAnswers>;
+
+    inline SampleAnswerTable& sample_answers() {
+        static SampleAnswerTable table;
+        return table;
+    }
+
+    class RegisterSampleAnswers {
+    public:
+        RegisterSampleAnswers(int day, SampleAnswers answers) {
+            sample_answers().emplace(day, answers);
+        }
+    };
+
+    // Where results and timings go. Defaults to std::cout; the runner points
+    // each thread at its own buffer when days run concurrently.
+    inline std::ostream*& output_stream() {
+        thread_local std::ostream* os = &std::cout;
+        return os;
+    }
+
+    inline std::ostream& out() {
+        return *output_stream();
+    }
+
+    // Redirect out() on this thread for the lifetime of the object
+    class ScopedOutput {
+    private:
+        std::ostream* prev_;
+
+    public:
+        explicit ScopedOutput(std::ostream& os)
+            : prev_(output_stream())
+        {
+            output_stream() = &os;
+        }
+
+        ~ScopedOutput() {
+            output_stream() = prev_;
         }
+
+        ScopedOutput(const ScopedOutput&) = delete;
+        ScopedOutput& operator=(const ScopedOutput&) = delete;
     };
 
     const auto print_result = [](int part, auto result) {
-        std::cout << "Part " << part << ": " << result << std::endl;
+        out() << "Part " << part << ": " << result << std::endl;
     };
 
     const auto print_results = [](const auto& part1, const auto& part2) {
@@ -52,29 +289,399 @@ namespace aoc {
         print_result(2, part2);
     };
 
-    auto open_argv_1(int argc, char **argv) {
+    // Results so far, for days printing as a stream comes in
+    const auto print_running = [](const auto& part1, const auto& part2) {
+        out() << "So far: Part 1: " << part1 << ", Part 2: " << part2 << std::endl;
+    };
+
+    inline auto open_argv_1(int argc, char **argv) {
         if (argc < 2) {
             throw std::runtime_error("Insufficient arguments");
         }
 
+        // "-" is stdin, as for MappedInput
         std::ifstream f;
-        f.open(argv[1]);
+        f.open(std::string_view(argv[1]) == "-" ? "/dev/stdin" : argv[1]);
         return f;
     };
 
-    std::ostream& bold_on(std::ostream& os) {
+    // Read-only memory mapping of an input file. Lines and tokens are handed
+    // out as string_views into the mapping, so nothing is copied unless the
+    // caller asks for a std::string. "-" (stdin), pipes and anything else
+    // that cannot be mapped are read into memory in full instead.
+    class MappedInput {
+    private:
+        const char* data_;
+        size_t size_;
+        size_t pos_;
+        std::vector<char> buffer_;
+
+    public:
+        MappedInput()
+            : data_(nullptr)
+            , size_(0)
+            , pos_(0)
+        { }
+
+        explicit MappedInput(const char* path)
+            : MappedInput()
+        {
+            open(path);
+        }
+
+        MappedInput(const MappedInput&) = delete;
+        MappedInput& operator=(const MappedInput&) = delete;
+
+        MappedInput(MappedInput&& rhs)
+            : data_(rhs.data_)
+            , size_(rhs.size_)
+            , pos_(rhs.pos_)
+            , buffer_(std::move(rhs.buffer_))
+        {
+            rhs.data_ = nullptr;
+            rhs.size_ = 0;
+            rhs.pos_ = 0;
+        }
+
+        MappedInput& operator=(MappedInput&& rhs) {
+            if (this != &rhs) {
+                close();
+                std::swap(data_, rhs.data_);
+                std::swap(size_, rhs.size_);
+                std::swap(pos_, rhs.pos_);
+                std::swap(buffer_, rhs.buffer_);
+            }
+            return *this;
+        }
+
+        ~MappedInput() {
+            close();
+        }
+
+        void open(const char* path) {
+            close();
+
+            const bool is_stdin = std::string_view(path) == "-";
+            const int fd = is_stdin ? STDIN_FILENO : ::open(path, O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error(std::string("Unable to open ") + path);
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) < 0) {
+                if (!is_stdin) {
+                    ::close(fd);
+                }
+                throw std::runtime_error(std::string("Unable to stat ") + path);
+            }
+
+            // mmap refuses zero length mappings, and files in /proc claim to
+            // be empty, so those are read like a pipe. So is a regular file
+            // the kernel will not map.
+            const bool mapped = S_ISREG(st.st_mode) && st.st_size > 0 && map(fd, st.st_size);
+            try {
+                if (!mapped) {
+                    read_all(fd, path);
+                }
+            } catch (...) {
+                if (!is_stdin) {
+                    ::close(fd);
+                }
+                throw;
+            }
+            if (!is_stdin) {
+                ::close(fd);
+            }
+        }
+
+        void close() {
+            if (data_ && buffer_.empty()) {
+                ::munmap(const_cast<char*>(data_), size_);
+            }
+            data_ = nullptr;
+            size_ = 0;
+            pos_ = 0;
+            buffer_ = std::vector<char>();
+        }
+
+        bool good() const {
+            return pos_ < size_;
+        }
+
+        void rewind() {
+            pos_ = 0;
+        }
+
+        // Mark n more bytes as consumed, for callers scanning remaining() themselves
+        void consume(size_t n) {
+            pos_ = std::min(size_, pos_ + n);
+        }
+
+        // The whole file, and the part not yet consumed
+        std::string_view view() const {
+            return std::string_view(data_, size_);
+        }
+
+        std::string_view remaining() const {
+            return std::string_view(data_ + pos_, size_ - pos_);
+        }
+
+        // Next non-empty line, without the trailing \r\n
+        bool next_line(std::string_view& out) {
+            while (pos_ < size_ && (data_[pos_] == '\n' || data_[pos_] == '\r')) {
+                pos_++;
+            }
+            if (pos_ >= size_) {
+                out = std::string_view();
+                return false;
+            }
+
+            const char* start = data_ + pos_;
+            const char* nl = static_cast<const char*>(::memchr(start, '\n', size_ - pos_));
+            const char* end = nl ? nl : data_ + size_;
+            pos_ = end - data_;
+
+            while (end > start && end[-1] == '\r') {
+                end--;
+            }
+            out = std::string_view(start, end - start);
+            return true;
+        }
+
+        // Next non-empty token separated by delim
+        bool next_token(std::string_view& out, const char delim) {
+            while (pos_ < size_ && data_[pos_] == delim) {
+                pos_++;
+            }
+            if (pos_ >= size_) {
+                out = std::string_view();
+                return false;
+            }
+
+            const char* start = data_ + pos_;
+            const char* d = static_cast<const char*>(::memchr(start, delim, size_ - pos_));
+            const char* end = d ? d : data_ + size_;
+            pos_ = end - data_;
+
+            out = std::string_view(start, end - start);
+            return true;
+        }
+
+        // Next non-empty token separated by any of delims
+        bool next_token(std::string_view& out, const std::string_view delims) {
+            if (delims.size() == 1) {
+                return next_token(out, delims[0]);
+            }
+
+            bool is_delim[256] = { };
+            for (const char c : delims) {
+                is_delim[static_cast<unsigned char>(c)] = true;
+            }
+
+            while (pos_ < size_ && is_delim[static_cast<unsigned char>(data_[pos_])]) {
+                pos_++;
+            }
+            if (pos_ >= size_) {
+                out = std::string_view();
+                return false;
+            }
+
+            const size_t start = pos_;
+            while (pos_ < size_ && !is_delim[static_cast<unsigned char>(data_[pos_])]) {
+                pos_++;
+            }
+
+            out = std::string_view(data_ + start, pos_ - start);
+            return true;
+        }
+
+    private:
+        bool map(int fd, size_t size) {
+            void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            ::madvise(p, size, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+            size_ = size;
+            return true;
+        }
+
+        void read_all(int fd, const char* path) {
+            size_t used = 0;
+            buffer_.resize(64 * 1024);
+            while (true) {
+                if (used == buffer_.size()) {
+                    buffer_.resize(buffer_.size() * 2);
+                }
+                const ssize_t n = ::read(fd, buffer_.data() + used, buffer_.size() - used);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0) {
+                    throw std::runtime_error(std::string("Unable to read ") + path);
+                }
+                if (n == 0) {
+                    break;
+                }
+                used += n;
+            }
+            buffer_.resize(used);
+            if (used > 0) {
+                data_ = buffer_.data();
+                size_ = used;
+            } else {
+                buffer_ = std::vector<char>();
+            }
+        }
+    };
+
+    inline auto map_argv_1(int argc, char **argv) {
+        if (argc < 2) {
+            throw std::runtime_error("Insufficient arguments");
+        }
+
+        return MappedInput(argv[1]);
+    };
+
+    // Forward only line reader for inputs that arrive over time: "-" (stdin),
+    // pipes and FIFOs, as well as plain files. Input is read in chunks into a
+    // buffer of fixed size, so memory stays constant however long the stream
+    // runs; a line must fit in the buffer. Lines are string_views into the
+    // buffer and last until the next call.
+    //
+    // on_idle() registers a callback run whenever the reader has caught up
+    // with the writer and is about to wait for more, after at least one new
+    // line. Days use it to print their running results. It never runs for a
+    // plain file, where the next chunk is always ready.
+    class StreamInput {
+    private:
+        int fd_;
+        std::string path_;
+        std::vector<char> buffer_;
+        size_t begin_;
+        size_t end_;
+        bool eof_;
+        bool fresh_;
+        std::function<void()> on_idle_;
+
+    public:
+        explicit StreamInput(const char* path, size_t capacity = 64 * 1024)
+            : fd_(-1)
+            , path_(path)
+            , buffer_(capacity)
+            , begin_(0)
+            , end_(0)
+            , eof_(false)
+            , fresh_(false)
+        {
+            fd_ = path_ == "-" ? STDIN_FILENO : ::open(path, O_RDONLY);
+            if (fd_ < 0) {
+                throw std::runtime_error("Unable to open " + path_);
+            }
+        }
+
+        StreamInput(const StreamInput&) = delete;
+        StreamInput& operator=(const StreamInput&) = delete;
+
+        ~StreamInput() {
+            close();
+        }
+
+        void close() {
+            if (fd_ > STDIN_FILENO) {
+                ::close(fd_);
+            }
+            fd_ = -1;
+            eof_ = true;
+            begin_ = end_ = 0;
+        }
+
+        void on_idle(std::function<void()> fn) {
+            on_idle_ = std::move(fn);
+        }
+
+        // Next non-empty line, without the trailing \r\n
+        bool next_line(std::string_view& out) {
+            while (true) {
+                while (begin_ < end_ && (buffer_[begin_] == '\n' || buffer_[begin_] == '\r')) {
+                    begin_++;
+                }
+
+                const char* start = buffer_.data() + begin_;
+                const char* nl = static_cast<const char*>(::memchr(start, '\n', end_ - begin_));
+                if (nl || (eof_ && begin_ < end_)) {
+                    const char* end = nl ? nl : buffer_.data() + end_;
+                    begin_ = end - buffer_.data();
+                    while (end > start && end[-1] == '\r') {
+                        end--;
+                    }
+                    out = std::string_view(start, end - start);
+                    fresh_ = true;
+                    return true;
+                }
+                if (eof_) {
+                    out = std::string_view();
+                    return false;
+                }
+                fill();
+            }
+        }
+
+    private:
+        // Moves the partial line left in the buffer to the front and reads
+        // behind it, waiting if nothing is ready
+        void fill() {
+            std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+            if (end_ == buffer_.size()) {
+                throw std::runtime_error("Line longer than " + std::to_string(buffer_.size()) + " bytes in " + path_);
+            }
+
+            if (fresh_ && on_idle_ && !ready()) {
+                fresh_ = false;
+                on_idle_();
+            }
+
+            ssize_t n;
+            do {
+                n = ::read(fd_, buffer_.data() + end_, buffer_.size() - end_);
+            } while (n < 0 && errno == EINTR);
+            if (n < 0) {
+                throw std::runtime_error("Unable to read " + path_);
+            }
+            eof_ = n == 0;
+            end_ += n;
+        }
+
+        bool ready() const {
+            pollfd p{ fd_, POLLIN, 0 };
+            return ::poll(&p, 1, 0) != 0;
+        }
+    };
+
+    inline auto stream_argv_1(int argc, char **argv) {
+        if (argc < 2) {
+            throw std::runtime_error("Insufficient arguments");
+        }
+
+        return StreamInput(argv[1]);
+    };
+
+    inline std::ostream& bold_on(std::ostream& os) {
         return os << "\e[1m";
     }
 
-    std::ostream& bold_off(std::ostream& os) {
+    inline std::ostream& bold_off(std::ostream& os) {
         return os << "\e[0m";
     }
 
-    std::ostream& cls(std::ostream& os) {
+    inline std::ostream& cls(std::ostream& os) {
         return os << "\033[2J\033[1;1H";
     }
 
-    bool getline(std::istream& s, std::string& out, const std::string_view delims) {
+    inline bool getline(std::istream& s, std::string& out, const std::string_view delims) {
         char c;
         out.resize(0);
         while (s.good() && (c = s.get())) {
@@ -90,10 +697,10 @@ namespace aoc {
         }
         return !out.empty() || s.good();
     }
-    bool getline(std::istream& s, std::string& out, const char delim) {
+    inline bool getline(std::istream& s, std::string& out, const char delim) {
         return getline(s, out, std::string_view(&delim, 1));
     }
-    bool getline(std::istream& s, std::string& out) {
+    inline bool getline(std::istream& s, std::string& out) {
         char c;
         out.resize(0);
         while (s.good() && (c = s.get())) {
@@ -112,92 +719,1825 @@ namespace aoc {
         return !out.empty() || s.good();
     }
 
-    using UnaryIntFunction = std::function<void(int)>;
-    void parse_as_integers(std::istream& s, const char delim, UnaryIntFunction op) {
-        std::string l;
-        while (getline(s, l, delim)) {
-            try {
-                int n = std::stoi(l);
-                op(n);
-            } catch (...) { }
-        }
+    // Drop in replacements for the istream versions above, reading from a mapping
+    inline bool getline(MappedInput& s, std::string_view& out, const std::string_view delims) {
+        return s.next_token(out, delims);
     }
-    void parse_as_integers(std::istream& s, const std::string_view delims, UnaryIntFunction op) {
-        std::string l;
-        while (getline(s, l, delims)) {
-            try {
-                int n = std::stoi(l);
-                op(n);
-            } catch (...) { }
-        }
+    inline bool getline(MappedInput& s, std::string_view& out, const char delim) {
+        return s.next_token(out, delim);
     }
-    void parse_as_integers(std::istream& s, UnaryIntFunction op) {
-        std::string l;
-        while (getline(s, l)) {
-            try {
-                int n = std::stoi(l);
-                op(n);
-            } catch (...) { }
-        }
+    inline bool getline(MappedInput& s, std::string_view& out) {
+        return s.next_line(out);
     }
-    void parse_as_integers(const std::string& s, const char delim, UnaryIntFunction op) {
-        std::stringstream ss(s);
-        std::string l;
-        while (getline(ss, l, delim)) {
-            try {
-                int n = std::stoi(l);
-                op(n);
-            } catch (...) { }
-        }
+    inline bool getline(MappedInput& s, std::string& out, const std::string_view delims) {
+        std::string_view sv;
+        const bool r = s.next_token(sv, delims);
+        out.assign(sv.data(), sv.size());
+        return r;
     }
-    void parse_as_integers(const std::string& s, const std::string_view delims, UnaryIntFunction op) {
-        std::stringstream ss(s);
-        std::string l;
-        while (getline(ss, l, delims)) {
-            try {
-                int n = std::stoi(l);
-                op(n);
-            } catch (...) { }
-        }
+    inline bool getline(MappedInput& s, std::string& out, const char delim) {
+        std::string_view sv;
+        const bool r = s.next_token(sv, delim);
+        out.assign(sv.data(), sv.size());
+        return r;
+    }
+    inline bool getline(MappedInput& s, std::string& out) {
+        std::string_view sv;
+        const bool r = s.next_line(sv);
+        out.assign(sv.data(), sv.size());
+        return r;
+    }
+    inline bool getline(StreamInput& s, std::string_view& out) {
+        return s.next_line(out);
+    }
+    inline bool getline(StreamInput& s, std::string& out) {
+        std::string_view sv;
+        const bool r = s.next_line(sv);
+        out.assign(sv.data(), sv.size());
+        return r;
     }
 
-    class AutoTimer {
-    private:
-        std::chrono::time_point<std::chrono::high_resolution_clock> start_;
-        std::string name_;
-
-    public:
-        AutoTimer()
-            : start_(std::chrono::high_resolution_clock::now())
-        { }
-
-        AutoTimer(const char *name)
-            : start_(std::chrono::high_resolution_clock::now())
-            , name_(name)
-        { }
+    using UnaryIntFunction = std::function<void(int)>;
 
-        ~AutoTimer() {
-            calculate_time();
+    // Parse a single integer token. Surrounding whitespace and a leading + are
+    // accepted, anything else left over is an error. No allocation, no exceptions.
+    template<typename T = int>
+    std::errc parse_integer(std::string_view s, T& out) {
+        while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) { s.remove_prefix(1); }
+        while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) { s.remove_suffix(1); }
+        if (s.size() > 1 && s[0] == '+' && s[1] != '-') {
+            s.remove_prefix(1);
         }
 
-        void elapsed() const {
-            calculate_time();
+        const auto r = std::from_chars(s.data(), s.data() + s.size(), out);
+        if (r.ec != std::errc()) {
+            return r.ec;
         }
+        return r.ptr == s.data() + s.size() ? std::errc() : std::errc::invalid_argument;
+    }
 
-        void reset() {
-            start_ = std::chrono::high_resolution_clock::now();
+    // Parsing for constexpr solvers, run on embedded sample inputs at compile
+    // time. Simple rather than fast; nothing here is meant for the real inputs.
+    namespace ct {
+        // Integer at the start of s, with an optional leading -. Parsing stops
+        // at the first character that is not a digit.
+        template<typename T = int>
+        constexpr T to_integer(std::string_view s) {
+            const bool negative = !s.empty() && s[0] == '-';
+            if (negative) {
+                s.remove_prefix(1);
+            }
+            T v = 0;
+            for (size_t i = 0; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++) {
+                v = v * 10 + (s[i] - '0');
+            }
+            return negative ? -v : v;
         }
 
-    private:
-        // Needs to be a lambda due to use of auto
-        void calculate_time () const {
-            const auto end = std::chrono::high_resolution_clock::now();
-
-            // Calculating total time taken by the program.
-            double time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count();
-            time_taken *= 1e-9;
+        // Calls op(token) for every non-empty token in s separated by delim
+        template<typename Fn>
+        constexpr void for_each_token(std::string_view s, const char delim, Fn&& op) {
+            while (!s.empty()) {
+                const auto p = s.find(delim);
+                const auto token = s.substr(0, p);
+                if (!token.empty()) {
+                    op(token);
+                }
+                if (p == std::string_view::npos) {
+                    break;
+                }
+                s.remove_prefix(p + 1);
+            }
+        }
+
+        // Calls op(line) for every non-empty line in s, without the trailing \r
+        template<typename Fn>
+        constexpr void for_each_line(std::string_view s, Fn&& op) {
+            for_each_token(s, '\n', [&op](std::string_view line) {
+                while (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+                if (!line.empty()) {
+                    op(line);
+                }
+            });
+        }
+
+        // Insertion sort, std::sort is not constexpr before C++20
+        template<typename It>
+        constexpr void sort(It first, It last) {
+            for (It i = first; i != last; ++i) {
+                for (It j = i; j != first && *j < *(j - 1); --j) {
+                    const auto t = *j;
+                    *j = *(j - 1);
+                    *(j - 1) = t;
+                }
+            }
+        }
+    };
+
+    // Runtime choice between the variants of a hot kernel, so one binary
+    // makes the most of whichever x86 host it lands on. The CPU is probed
+    // once; the runner's --isa can then pin a lower level for comparing the
+    // variants on one machine.
+    namespace isa {
+        enum class Level {
+            Scalar,
+            SSE42,
+            AVX2,
+            AVX512,
+        };
+
+        constexpr size_t Levels = 4;
+
+        inline const char* name(const Level l) {
+            switch (l) {
+                case Level::Scalar: return "scalar";
+                case Level::SSE42: return "sse4.2";
+                case Level::AVX2: return "avx2";
+                case Level::AVX512: return "avx512";
+            }
+            return "?";
+        }
+
+        inline bool parse(const std::string_view s, Level& l) {
+            for (size_t i = 0; i < Levels; i++) {
+                if (s == name(static_cast<Level>(i))) {
+                    l = static_cast<Level>(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // The widest level this CPU and OS run. AVX-512 needs BW for the
+        // byte kernels.
+        inline Level detected() {
+            static const Level level = []() {
+#if defined(AOC_ISA_X86)
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+                    return Level::AVX512;
+                }
+                if (__builtin_cpu_supports("avx2")) {
+                    return Level::AVX2;
+                }
+                if (__builtin_cpu_supports("sse4.2")) {
+                    return Level::SSE42;
+                }
+#endif
+                return Level::Scalar;
+            }();
+            return level;
+        }
+
+        class Selection {
+        public:
+            bool pinned = false;
+            Level level = Level::Scalar;
+        };
+
+        inline Selection& selection() {
+            static Selection s;
+            return s;
+        }
+
+        // The level kernels run at: detected(), unless select() lowered it
+        inline Level selected() {
+            const auto& s = selection();
+            return s.pinned ? s.level : detected();
+        }
+
+        // Pins the level for every kernel from here on. Throws if the CPU
+        // can not run it.
+        inline void select(const Level l) {
+            if (l > detected()) {
+                throw std::runtime_error(std::string("This CPU does not support ") + name(l) + ", only up to " + name(detected()));
+            }
+            selection() = Selection{ true, l };
+        }
+
+        // The variants of one kernel, by level. Every level but Scalar may be
+        // left out, and best() falls back to the next one down.
+        template<typename Fn>
+        class Kernel {
+        private:
+            std::array<Fn*, Levels> variants_;
+
+        public:
+            constexpr Kernel(Fn* scalar, Fn* sse42 = nullptr, Fn* avx2 = nullptr, Fn* avx512 = nullptr)
+                : variants_{ scalar, sse42, avx2, avx512 }
+            {
+            }
+
+            // Look this up once outside the loop that calls it
+            Fn* best() const {
+                size_t i = static_cast<size_t>(selected());
+                while (!variants_[i]) {
+                    i--;
+                }
+                return variants_[i];
+            }
+        };
+    };
+
+    namespace simd {
+        // Delimiter set for the tokenizer. pcmpestrm takes up to 16 needles, and
+        // the scalar table covers the rest.
+        class DelimiterSet {
+        public:
+            bool table[256];
+            char chars[16];
+            int count;
+
+            explicit DelimiterSet(const std::string_view delims)
+                : table()
+                , chars()
+                , count(0)
+            {
+                for (const char c : delims) {
+                    if (table[static_cast<unsigned char>(c)]) {
+                        continue;
+                    }
+                    table[static_cast<unsigned char>(c)] = true;
+                    if (count < 16) {
+                        chars[count] = c;
+                    }
+                    count++;
+                }
+            }
+
+            bool vectorizable() const {
+                return count <= 16;
+            }
+        };
+
+        // Bitmask of the delimiters in the 64 bytes at p, bit i set for p[i]
+        inline uint64_t block_mask_scalar(const char* p, const DelimiterSet& d) {
+            uint64_t m = 0;
+            for (int i = 0; i < 64; i++) {
+                m |= static_cast<uint64_t>(d.table[static_cast<unsigned char>(p[i])]) << i;
+            }
+            return m;
+        }
+
+#if defined(AOC_ISA_X86)
+        AOC_TARGET("sse4.2") inline uint64_t block_mask_sse42(const char* p, const DelimiterSet& d) {
+            constexpr int Mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+            const __m128i needles = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d.chars));
+            uint64_t m = 0;
+            for (int i = 0; i < 4; i++) {
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+                const __m128i r = _mm_cmpestrm(needles, d.count, b, 16, Mode);
+                m |= static_cast<uint64_t>(_mm_cvtsi128_si32(r) & 0xffff) << (i * 16);
+            }
+            return m;
+        }
+
+        AOC_TARGET("avx2") inline uint64_t block_mask_avx2(const char* p, const DelimiterSet& d) {
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+            __m256i mlo = _mm256_setzero_si256();
+            __m256i mhi = _mm256_setzero_si256();
+            for (int i = 0; i < d.count; i++) {
+                const __m256i c = _mm256_set1_epi8(d.chars[i]);
+                mlo = _mm256_or_si256(mlo, _mm256_cmpeq_epi8(lo, c));
+                mhi = _mm256_or_si256(mhi, _mm256_cmpeq_epi8(hi, c));
+            }
+            return static_cast<uint32_t>(_mm256_movemask_epi8(mlo)) |
+                (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(mhi))) << 32);
+        }
+
+        AOC_TARGET("avx512f,avx512bw") inline uint64_t block_mask_avx512(const char* p, const DelimiterSet& d) {
+            const __m512i b = _mm512_loadu_si512(p);
+            __mmask64 m = 0;
+            for (int i = 0; i < d.count; i++) {
+                m |= _mm512_cmpeq_epi8_mask(b, _mm512_set1_epi8(d.chars[i]));
+            }
+            return m;
+        }
+
+        // Up to 16 delimiters; more than that always take the scalar table
+        inline const isa::Kernel<uint64_t(const char*, const DelimiterSet&)> block_mask{
+            block_mask_scalar, block_mask_sse42, block_mask_avx2, block_mask_avx512 };
+#else
+        inline const isa::Kernel<uint64_t(const char*, const DelimiterSet&)> block_mask{ block_mask_scalar };
+#endif
+
+        // Call op(token) for every non-empty token of s, splitting on any of
+        // delims. Delimiters are located 64 bytes at a time and the tokens are
+        // walked off the resulting bitmask.
+        template<typename Fn>
+        void for_each_token(std::string_view s, const std::string_view delims, Fn&& op) {
+            const DelimiterSet d(delims);
+            const auto mask_of = d.vectorizable() ? block_mask.best() : block_mask_scalar;
+            const char* const base = s.data();
+            const size_t n = s.size();
+
+            size_t start = 0;
+            const auto emit = [&](uint64_t mask, size_t block) {
+                while (mask) {
+                    const size_t end = block + __builtin_ctzll(mask);
+                    if (end > start) {
+                        op(std::string_view(base + start, end - start));
+                    }
+                    start = end + 1;
+                    mask &= mask - 1;
+                }
+            };
+
+            size_t block = 0;
+            for (; block + 64 <= n; block += 64) {
+                emit(mask_of(base + block, d), block);
+            }
+            if (block < n) {
+                // Pad the tail out to a full block, NUL never being a delimiter here
+                char tail[64] = { };
+                ::memcpy(tail, base + block, n - block);
+                uint64_t mask = mask_of(tail, d);
+                mask &= (n - block == 64) ? ~0ULL : ((1ULL << (n - block)) - 1);
+                emit(mask, block);
+            }
+            if (start < n) {
+                op(std::string_view(base + start, n - start));
+            }
+        }
+
+        // Convert len (1..8) ASCII digits at p. Returns false if any of them is
+        // not a digit. If over_read is set 8 bytes at p may be loaded.
+        inline bool parse_digits8(const char* p, size_t len, bool over_read, uint32_t& out) {
+            assert(len > 0 && len <= 8);
+            uint64_t v = 0;
+            if (over_read) {
+                ::memcpy(&v, p, 8);
+            } else {
+                ::memcpy(&v, p, len);
+            }
+            // Right align the digits so the most significant ends up in the high
+            // bytes we pull in from the left, and the missing ones become zero
+            const int shift = static_cast<int>(8 - len) * 8;
+            v <<= shift;
+            const uint64_t zeros = 0x3030303030303030ULL << shift;
+            v -= zeros;
+            // Any byte outside 0..9 now has its top bit set, either itself or after +0x76
+            if (((v | (v + 0x7676767676767676ULL)) & 0x8080808080808080ULL) != 0) {
+                return false;
+            }
+#if defined(__SSE4_1__)
+            const __m128i d = _mm_cvtsi64_si128(static_cast<long long>(v));
+            const __m128i p1 = _mm_maddubs_epi16(d, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 0, 0, 0, 0, 0, 0, 0, 0));
+            const __m128i p2 = _mm_madd_epi16(p1, _mm_setr_epi16(100, 1, 100, 1, 0, 0, 0, 0));
+            const __m128i p3 = _mm_packus_epi32(p2, p2);
+            const __m128i p4 = _mm_madd_epi16(p3, _mm_setr_epi16(10000, 1, 0, 0, 0, 0, 0, 0));
+            out = static_cast<uint32_t>(_mm_cvtsi128_si32(p4));
+#else
+            v = (v * 10) + (v >> 8);
+            v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+                (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+            out = static_cast<uint32_t>(v);
+#endif
+            return true;
+        }
+    };
+
+    namespace detail {
+        // Digits-only tokens of up to 8 characters, optionally negated, take the
+        // vector path. Anything else goes through parse_integer.
+        template<typename T>
+        bool parse_token_fast(std::string_view tok, const char* buf_end, T& out) {
+            if constexpr (!std::is_integral_v<T> || sizeof(T) < sizeof(uint32_t)) {
+                return false;
+            } else {
+                const bool neg = !tok.empty() && tok[0] == '-';
+                if (neg) {
+                    if constexpr (std::is_unsigned_v<T>) {
+                        return false;
+                    }
+                    tok.remove_prefix(1);
+                }
+                if (tok.empty() || tok.size() > 8) {
+                    return false;
+                }
+                uint32_t v;
+                if (!simd::parse_digits8(tok.data(), tok.size(), tok.data() + 8 <= buf_end, v)) {
+                    return false;
+                }
+                if (v > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+                    return false;
+                }
+                out = neg ? static_cast<T>(-static_cast<int64_t>(v)) : static_cast<T>(v);
+                return true;
+            }
+        }
+
+        // Parse tok and hand it to op, remembering the first failure
+        template<typename T, typename Fn>
+        void parse_token(std::string_view tok, Fn& op, std::errc& first_error, const char* buf_end = nullptr) {
+            T n;
+            if (buf_end && parse_token_fast(tok, buf_end, n)) {
+                op(n);
+                return;
+            }
+            const auto ec = parse_integer(tok, n);
+            if (ec == std::errc()) {
+                op(n);
+            } else if (first_error == std::errc()) {
+                first_error = ec;
+            }
+        }
+
+        template<typename T, typename Fn>
+        std::errc parse_tokens(std::string_view s, const std::string_view delims, Fn& op) {
+            std::errc ec{};
+            const char* end = s.data() + s.size();
+            simd::for_each_token(s, delims, [&](std::string_view tok) {
+                parse_token<T>(tok, op, ec, end);
+            });
+            return ec;
+        }
+    };
+
+    // Call op(n) for every integer in s separated by any of delims. Tokens that
+    // fail to parse are skipped and the first error is returned, std::errc()
+    // when every token was good.
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(std::string_view s, const std::string_view delims, Fn&& op) {
+        return detail::parse_tokens<T>(s, delims, op);
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(std::string_view s, const char delim, Fn&& op) {
+        return detail::parse_tokens<T>(s, std::string_view(&delim, 1), op);
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(MappedInput& s, const std::string_view delims, Fn&& op) {
+        const auto r = s.remaining();
+        s.consume(r.size());
+        return detail::parse_tokens<T>(r, delims, op);
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(MappedInput& s, const char delim, Fn&& op) {
+        return parse_as_integers<T>(s, std::string_view(&delim, 1), op);
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(MappedInput& s, Fn&& op) {
+        return parse_as_integers<T>(s, std::string_view("\r\n"), op);
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(StreamInput& s, Fn&& op) {
+        std::errc ec{};
+        std::string_view l;
+        while (s.next_line(l)) {
+            detail::parse_token<T>(l, op, ec);
+        }
+        return ec;
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(std::istream& s, const char delim, Fn&& op) {
+        std::errc ec{};
+        std::string l;
+        while (getline(s, l, delim)) {
+            detail::parse_token<T>(l, op, ec);
+        }
+        return ec;
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(std::istream& s, const std::string_view delims, Fn&& op) {
+        std::errc ec{};
+        std::string l;
+        while (getline(s, l, delims)) {
+            detail::parse_token<T>(l, op, ec);
+        }
+        return ec;
+    }
+    template<typename T = int, typename Fn>
+    std::errc parse_as_integers(std::istream& s, Fn&& op) {
+        std::errc ec{};
+        std::string l;
+        while (getline(s, l)) {
+            detail::parse_token<T>(l, op, ec);
+        }
+        return ec;
+    }
+
+    inline uint64_t hash_combine(uint64_t seed, uint64_t h) {
+        return mix64(seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+    }
+
+    // Hash for FlatHashMap and FlatHashSet. Integers go through mix64, pairs,
+    // tuples and arrays are combined element by element, and strings can be
+    // looked up by string_view.
+    template<typename T, typename = void>
+    struct Hash {
+        uint64_t operator()(const T& v) const {
+            return mix64(std::hash<T>{}(v));
+        }
+    };
+
+    template<typename T>
+    struct Hash<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>> {
+        uint64_t operator()(T v) const {
+            return mix64(static_cast<uint64_t>(v));
+        }
+    };
+
+    template<>
+    struct Hash<PackedPoint2> {
+        uint64_t operator()(const PackedPoint2& p) const {
+            return mix64(p.key);
+        }
+    };
+
+    template<>
+    struct Hash<PackedPoint3> {
+        uint64_t operator()(const PackedPoint3& p) const {
+            return mix64(p.key);
+        }
+    };
+
+    template<typename A, typename B>
+    struct Hash<std::pair<A, B>> {
+        uint64_t operator()(const std::pair<A, B>& v) const {
+            return hash_combine(Hash<A>{}(v.first), Hash<B>{}(v.second));
+        }
+    };
+
+    template<typename... Ts>
+    struct Hash<std::tuple<Ts...>> {
+        uint64_t operator()(const std::tuple<Ts...>& v) const {
+            return std::apply([](const auto&... e) {
+                uint64_t h = 0;
+                ((h = hash_combine(h, Hash<std::decay_t<decltype(e)>>{}(e))), ...);
+                return h;
+            }, v);
+        }
+    };
+
+    template<typename T, size_t N>
+    struct Hash<std::array<T, N>> {
+        uint64_t operator()(const std::array<T, N>& v) const {
+            uint64_t h = 0;
+            for (const auto& e : v) {
+                h = hash_combine(h, Hash<T>{}(e));
+            }
+            return h;
+        }
+    };
+
+    template<>
+    struct Hash<std::string> {
+        uint64_t operator()(std::string_view v) const {
+            return mix64(std::hash<std::string_view>{}(v));
+        }
+    };
+
+    namespace detail {
+        // Open addressing with linear probing over a power of two number of
+        // slots, kept at most three quarters full. One byte per slot says
+        // whether it is in use; erase shifts the rest of the run back so no
+        // tombstones are needed. Iterators and references are invalidated by
+        // any insert that grows the table, and by erase.
+        template<typename Key, typename Value, typename KeyOf, typename HashFn, typename Eq>
+        class FlatTable {
+        protected:
+            std::vector<Value> slots_;
+            std::vector<uint8_t> used_;
+            size_t size_ = 0;
+            size_t mask_ = 0;
+
+        public:
+            template<typename V, typename T>
+            class Iterator {
+                friend class FlatTable;
+                T* table_;
+                size_t i_;
+
+                Iterator(T* table, size_t i)
+                    : table_(table)
+                    , i_(i)
+                {
+                    skip();
+                }
+
+                void skip() {
+                    while (i_ < table_->used_.size() && !table_->used_[i_]) {
+                        i_++;
+                    }
+                }
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Value;
+                using difference_type = std::ptrdiff_t;
+                using pointer = V*;
+                using reference = V&;
+
+                V& operator*() const { return table_->slots_[i_]; }
+                V* operator->() const { return &table_->slots_[i_]; }
+                Iterator& operator++() {
+                    i_++;
+                    skip();
+                    return *this;
+                }
+                Iterator operator++(int) {
+                    auto it = *this;
+                    ++*this;
+                    return it;
+                }
+                bool operator==(const Iterator& rhs) const { return i_ == rhs.i_; }
+                bool operator!=(const Iterator& rhs) const { return i_ != rhs.i_; }
+            };
+
+            using key_type = Key;
+            using value_type = Value;
+            using iterator = Iterator<Value, FlatTable>;
+            using const_iterator = Iterator<const Value, const FlatTable>;
+
+            iterator begin() { return iterator(this, 0); }
+            iterator end() { return iterator(this, used_.size()); }
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, used_.size()); }
+
+            size_t size() const { return size_; }
+            bool empty() const { return size_ == 0; }
+
+            // Heap bytes held by the table itself
+            size_t memory() const { return slots_.capacity() * sizeof(Value) + used_.capacity(); }
+
+            void clear() {
+                std::fill(used_.begin(), used_.end(), 0);
+                std::fill(slots_.begin(), slots_.end(), Value());
+                size_ = 0;
+            }
+
+            // Room for n entries without growing
+            void reserve(size_t n) {
+                size_t capacity = 8;
+                while (capacity * 3 < n * 4) {
+                    capacity *= 2;
+                }
+                if (capacity > used_.size()) {
+                    rehash(capacity);
+                }
+            }
+
+            template<typename Q>
+            iterator find(const Q& key) {
+                return iterator(this, find_slot(key));
+            }
+
+            template<typename Q>
+            const_iterator find(const Q& key) const {
+                return const_iterator(this, find_slot(key));
+            }
+
+            template<typename Q>
+            bool contains(const Q& key) const {
+                return find_slot(key) != used_.size();
+            }
+
+            template<typename Q>
+            size_t count(const Q& key) const {
+                return contains(key);
+            }
+
+            template<typename Q>
+            size_t erase(const Q& key) {
+                size_t i = find_slot(key);
+                if (i == used_.size()) {
+                    return 0;
+                }
+
+                // Pull back any later entry of the run that may sit at i
+                for (size_t j = (i + 1) & mask_; used_[j]; j = (j + 1) & mask_) {
+                    const size_t home = HashFn{}(KeyOf{}(slots_[j])) & mask_;
+                    if (((j - home) & mask_) >= ((j - i) & mask_)) {
+                        slots_[i] = std::move(slots_[j]);
+                        i = j;
+                    }
+                }
+                used_[i] = 0;
+                slots_[i] = Value();
+                size_--;
+                return 1;
+            }
+
+        protected:
+            template<typename Q>
+            size_t find_slot(const Q& key) const {
+                if (size_ == 0) {
+                    return used_.size();
+                }
+                for (size_t i = HashFn{}(key) & mask_; used_[i]; i = (i + 1) & mask_) {
+                    if (Eq{}(KeyOf{}(slots_[i]), key)) {
+                        return i;
+                    }
+                }
+                return used_.size();
+            }
+
+            // Finds key, or calls make() to build the value in the slot it should go in
+            template<typename Fn>
+            std::pair<iterator, bool> insert_with(const Key& key, Fn&& make) {
+                if ((size_ + 1) * 4 > used_.size() * 3) {
+                    rehash(std::max<size_t>(8, used_.size() * 2));
+                }
+
+                size_t i = HashFn{}(key) & mask_;
+                for (; used_[i]; i = (i + 1) & mask_) {
+                    if (Eq{}(KeyOf{}(slots_[i]), key)) {
+                        return { iterator(this, i), false };
+                    }
+                }
+                slots_[i] = make();
+                used_[i] = 1;
+                size_++;
+                return { iterator(this, i), true };
+            }
+
+            void rehash(size_t capacity) {
+                std::vector<Value> slots(capacity);
+                std::vector<uint8_t> used(capacity, 0);
+                const size_t mask = capacity - 1;
+                for (size_t j = 0; j < used_.size(); j++) {
+                    if (!used_[j]) {
+                        continue;
+                    }
+                    size_t i = HashFn{}(KeyOf{}(slots_[j])) & mask;
+                    while (used[i]) {
+                        i = (i + 1) & mask;
+                    }
+                    slots[i] = std::move(slots_[j]);
+                    used[i] = 1;
+                }
+                slots_ = std::move(slots);
+                used_ = std::move(used);
+                mask_ = mask;
+            }
+        };
+
+        struct FirstOf {
+            template<typename P>
+            const auto& operator()(const P& p) const { return p.first; }
+        };
+
+        struct Itself {
+            template<typename K>
+            const K& operator()(const K& k) const { return k; }
+        };
+    };
+
+    // Drop in for std::map / std::unordered_map where order does not matter.
+    // Keys and values must be default constructible, empty slots hold them.
+    template<typename K, typename V, typename HashFn = Hash<K>, typename Eq = std::equal_to<>>
+    class FlatHashMap : public detail::FlatTable<K, std::pair<K, V>, detail::FirstOf, HashFn, Eq> {
+        using Base = detail::FlatTable<K, std::pair<K, V>, detail::FirstOf, HashFn, Eq>;
+
+    public:
+        using mapped_type = V;
+        using typename Base::iterator;
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+            return this->insert_with(key, [&]() { return std::pair<K, V>(key, V(std::forward<Args>(args)...)); });
+        }
+
+        template<typename KK, typename VV>
+        std::pair<iterator, bool> emplace(KK&& key, VV&& value) {
+            return try_emplace(K(std::forward<KK>(key)), std::forward<VV>(value));
+        }
+
+        V& operator[](const K& key) {
+            return try_emplace(key).first->second;
+        }
+
+        template<typename Q>
+        const V& at(const Q& key) const {
+            const auto it = this->find(key);
+            if (it == this->end()) {
+                throw std::out_of_range("FlatHashMap::at");
+            }
+            return it->second;
+        }
+    };
+
+    template<typename K, typename HashFn = Hash<K>, typename Eq = std::equal_to<>>
+    class FlatHashSet : public detail::FlatTable<K, K, detail::Itself, HashFn, Eq> {
+    public:
+        using typename detail::FlatTable<K, K, detail::Itself, HashFn, Eq>::iterator;
+
+        std::pair<iterator, bool> insert(const K& key) {
+            return this->insert_with(key, [&]() { return key; });
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            return insert(K(std::forward<Args>(args)...));
+        }
+    };
+
+    // Allocator handing out storage aligned to Align bytes, so a container's
+    // first element starts on a cache line
+    template<typename T, size_t Align = 64>
+    class AlignedAllocator {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Align>;
+        };
+
+        AlignedAllocator() = default;
+
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Align>&) { }
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+        }
+
+        void deallocate(T* p, size_t) {
+            ::operator delete(p, std::align_val_t(Align));
+        }
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+        template<typename U>
+        bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+    };
+
+    // Row-major 2D grid in a single allocation. Every row starts on a cache
+    // line and has pad cells of the border value on each side (and pad rows
+    // above and below), so neighbours of an edge cell can be read without
+    // bounds checks. A wrapping grid is a torus instead: coordinates passed
+    // to index() are taken modulo the size.
+    //
+    // Cells are addressed as (x, y), or by the linear index() of a cell, to
+    // which the offsets from offset(), orthogonal() and adjacent() can be
+    // added while the neighbour stays within the padding.
+    template<typename T>
+    class Grid2D {
+        static_assert(!std::is_same_v<T, bool>, "Grid2D<bool> would be a bit vector, use uint8_t");
+
+    private:
+        static constexpr size_t line_ = 64;
+
+        size_t width_;
+        size_t height_;
+        size_t pad_;
+        size_t stride_;
+        bool wrap_;
+        T border_;
+        std::array<ptrdiff_t, 4> orthogonal_;
+        std::array<ptrdiff_t, 8> adjacent_;
+        std::vector<T, AlignedAllocator<T, line_>> cells_;
+
+    public:
+        Grid2D()
+            : Grid2D(0, 0)
+        { }
+
+        Grid2D(size_t width, size_t height, T border = T(), size_t pad = 0, bool wrap = false)
+            : width_(0)
+            , height_(height)
+            , pad_(pad)
+            , stride_(0)
+            , wrap_(wrap)
+            , border_(border)
+            , orthogonal_()
+            , adjacent_()
+        {
+            set_width(width);
+            cells_.assign(stride_ * (height_ + 2 * pad_), border_);
+        }
+
+        // Toroidal grid, which has no need for padding
+        static Grid2D wrapping(size_t width, size_t height, T fill = T()) {
+            return Grid2D(width, height, fill, 0, true);
+        }
+
+        size_t width() const { return width_; }
+        size_t height() const { return height_; }
+        size_t size() const { return width_ * height_; }
+        size_t pad() const { return pad_; }
+        size_t stride() const { return stride_; }
+        // Cells padding included, one past the largest operator[] index
+        size_t cells() const { return cells_.size(); }
+        bool wraps() const { return wrap_; }
+
+        // Appends a row of cells converted by op(element), for grids built a
+        // line at a time. The first row sets the width of an empty grid.
+        template<typename Range, typename Fn>
+        void push_row(const Range& r, Fn&& op) {
+            if (width_ == 0 && height_ == 0) {
+                set_width(std::size(r));
+                cells_.assign(stride_ * 2 * pad_, border_);
+            }
+            if (std::size(r) != width_) {
+                throw std::runtime_error("Ragged grid row");
+            }
+
+            // The bottom padding moves down a row
+            const auto first = cells_.size() - stride_ * pad_ + pad_;
+            cells_.resize(cells_.size() + stride_, border_);
+            auto it = cells_.begin() + first;
+            for (const auto& e : r) {
+                *it++ = op(e);
+            }
+            height_++;
+        }
+
+        template<typename Range>
+        void push_row(const Range& r) {
+            push_row(r, [](const auto& e) { return static_cast<T>(e); });
+        }
+
+        size_t index(ptrdiff_t x, ptrdiff_t y) const {
+            if (wrap_) {
+                x = wrap(x, width_);
+                y = wrap(y, height_);
+            }
+            assert(x >= -static_cast<ptrdiff_t>(pad_) && x < static_cast<ptrdiff_t>(width_ + pad_));
+            assert(y >= -static_cast<ptrdiff_t>(pad_) && y < static_cast<ptrdiff_t>(height_ + pad_));
+            return (y + pad_) * stride_ + x + pad_;
+        }
+
+        size_t x_of(size_t i) const { return i % stride_ - pad_; }
+        size_t y_of(size_t i) const { return i / stride_ - pad_; }
+
+        T& operator()(ptrdiff_t x, ptrdiff_t y) { return cells_[index(x, y)]; }
+        const T& operator()(ptrdiff_t x, ptrdiff_t y) const { return cells_[index(x, y)]; }
+        T& operator[](size_t i) { return cells_[i]; }
+        const T& operator[](size_t i) const { return cells_[i]; }
+
+        // First (unpadded) cell of row y, for y in [0, height)
+        T* row(size_t y) { return cells_.data() + (y + pad_) * stride_ + pad_; }
+        const T* row(size_t y) const { return cells_.data() + (y + pad_) * stride_ + pad_; }
+
+        ptrdiff_t offset(ptrdiff_t dx, ptrdiff_t dy) const {
+            return dy * static_cast<ptrdiff_t>(stride_) + dx;
+        }
+
+        // Up, left, right, down
+        const std::array<ptrdiff_t, 4>& orthogonal() const { return orthogonal_; }
+        // The eight cells around one, in row order
+        const std::array<ptrdiff_t, 8>& adjacent() const { return adjacent_; }
+
+        // Sets every cell, padding included
+        void fill(const T& v) {
+            std::fill(cells_.begin(), cells_.end(), v);
+        }
+
+        // Calls op(index) for every cell inside the padding, in memory order
+        template<typename Fn>
+        void for_each_index(Fn&& op) const {
+            for (size_t y = 0; y < height_; y++) {
+                const size_t first = index(0, y);
+                for (size_t i = first; i < first + width_; i++) {
+                    op(i);
+                }
+            }
+        }
+
+    private:
+        // Mostly called one step off the edge, so skip the division when we can
+        static ptrdiff_t wrap(ptrdiff_t v, size_t n) {
+            const auto sn = static_cast<ptrdiff_t>(n);
+            if (v >= 0 && v < sn) {
+                return v;
+            } else if (v == sn) {
+                return 0;
+            } else if (v == -1) {
+                return sn - 1;
+            }
+            v %= sn;
+            return v < 0 ? v + sn : v;
+        }
+
+        void set_width(size_t width) {
+            width_ = width;
+            stride_ = width_ + 2 * pad_;
+            // Round rows up to whole cache lines, when cells pack into them
+            if (sizeof(T) <= line_ && line_ % sizeof(T) == 0) {
+                const size_t per_line = line_ / sizeof(T);
+                stride_ = (stride_ + per_line - 1) / per_line * per_line;
+            }
+
+            orthogonal_ = { offset(0, -1), offset(-1, 0), offset(1, 0), offset(0, 1) };
+            adjacent_ = { offset(-1, -1), offset(0, -1), offset(1, -1), offset(-1, 0),
+                offset(1, 0), offset(-1, 1), offset(0, 1), offset(1, 1) };
+        }
+    };
+
+    // Bump allocator, usable directly or as the memory_resource of pmr
+    // containers. Allocating moves a pointer through the current block and
+    // deallocating does nothing; memory comes back all at once on reset() or
+    // destruction, and no destructors are run for what was in it. reset()
+    // folds the blocks into one big enough for everything handed out so far,
+    // so an arena reused per iteration soon stops calling the heap at all.
+    class Arena final : public std::pmr::memory_resource {
+    private:
+        struct Block {
+            Block* next;
+            size_t size;
+        };
+        static_assert(sizeof(Block) % alignof(std::max_align_t) == 0);
+
+        Block* blocks_;
+        std::byte* ptr_;
+        std::byte* end_;
+        size_t next_size_;
+
+    public:
+        explicit Arena(size_t block_size = 64 * 1024)
+            : blocks_(nullptr)
+            , ptr_(nullptr)
+            , end_(nullptr)
+            , next_size_(block_size)
+        { }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena() {
+            release();
+        }
+
+        // Bytes held, across all blocks
+        size_t capacity() const {
+            size_t total = 0;
+            for (auto* b = blocks_; b; b = b->next) {
+                total += b->size;
+            }
+            return total;
+        }
+
+        void reset() {
+            if (blocks_ && blocks_->next) {
+                const size_t total = capacity();
+                release();
+                add_block(total);
+            } else if (blocks_) {
+                ptr_ = data(blocks_);
+            }
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t align) override {
+            std::byte* p = align_up(ptr_, align);
+            if (!p || p + bytes > end_) {
+                add_block(std::max(next_size_, bytes + align));
+                p = align_up(ptr_, align);
+            }
+            ptr_ = p + bytes;
+            return p;
+        }
+
+        void do_deallocate(void*, size_t, size_t) override { }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        static std::byte* data(Block* b) {
+            return reinterpret_cast<std::byte*>(b + 1);
+        }
+
+        static std::byte* align_up(std::byte* p, size_t align) {
+            const auto v = reinterpret_cast<uintptr_t>(p);
+            return reinterpret_cast<std::byte*>((v + align - 1) & ~(align - 1));
+        }
+
+        void add_block(size_t size) {
+            auto* b = static_cast<Block*>(::operator new(sizeof(Block) + size));
+            b->next = blocks_;
+            b->size = size;
+            blocks_ = b;
+            ptr_ = data(b);
+            end_ = ptr_ + size;
+            next_size_ = std::max(next_size_, size * 2);
+        }
+
+        void release() {
+            while (blocks_) {
+                auto* next = blocks_->next;
+                ::operator delete(blocks_);
+                blocks_ = next;
+            }
+            ptr_ = nullptr;
+            end_ = nullptr;
+        }
+    };
+
+    // Heap bytes a container holds, not counting anything its elements own
+    // in turn. Tree nodes are estimated from libstdc++'s layout: a colour and
+    // three links ahead of the value.
+    template<typename T, typename A>
+    size_t footprint(const std::vector<T, A>& v) {
+        return v.capacity() * sizeof(T);
+    }
+    template<typename C, typename = typename C::key_compare>
+    size_t footprint(const C& c) {
+        return c.size() * (4 * sizeof(void*) + sizeof(typename C::value_type));
+    }
+    template<typename K, typename V, typename KeyOf, typename HashFn, typename Eq>
+    size_t footprint(const detail::FlatTable<K, V, KeyOf, HashFn, Eq>& t) {
+        return t.memory();
+    }
+
+    // The phase a thread is in, set by AutoTimer::phase()
+    inline const char*& current_phase() {
+        thread_local const char* phase = nullptr;
+        return phase;
+    }
+
+    // The runner's --memory. At the end of every phase AutoTimer prints the
+    // resident set, current and peak, then whatever the day noted with
+    // note_footprint() during the phase.
+    class MemoryReport {
+    public:
+        class Note {
+        public:
+            const char* name;
+            size_t entries;
+            size_t bytes;
+        };
+
+        static bool& enabled() {
+            static bool on = false;
+            return on;
+        }
+
+        static std::vector<Note>& notes() {
+            thread_local std::vector<Note> n;
+            return n;
+        }
+
+        // Bytes resident now, from /proc/self/statm
+        static size_t rss() {
+            std::ifstream f("/proc/self/statm");
+            size_t pages = 0;
+            size_t resident = 0;
+            f >> pages >> resident;
+            return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        }
+
+        // Most bytes ever resident, for the whole process. VmHWM is kept up
+        // to date where getrusage() can lag behind the current resident set.
+        static size_t peak_rss() {
+            std::ifstream f("/proc/self/status");
+            std::string line;
+            while (std::getline(f, line)) {
+                size_t kib = 0;
+                if (line.compare(0, 6, "VmHWM:") == 0 && parse_integer(std::string_view(line).substr(6, line.size() - 9), kib) == std::errc()) {
+                    return kib * 1024;
+                }
+            }
+            rusage u;
+            ::getrusage(RUSAGE_SELF, &u);
+            return static_cast<size_t>(u.ru_maxrss) * 1024;
+        }
+
+        static void print(std::ostream& os, const char* phase) {
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+            os << std::fixed << std::setprecision(1);
+            os << "Memory " << phase << ": rss " << mib(rss()) << " MiB, peak rss " << mib(peak_rss()) << " MiB" << std::endl;
+            for (const auto& n : notes()) {
+                os << "Memory " << phase << ": " << n.name << " " << n.entries << " entries, " << mib(n.bytes) << " MiB" << std::endl;
+            }
+            notes().clear();
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+    private:
+        static double mib(size_t bytes) {
+            return bytes / (1024.0 * 1024.0);
+        }
+    };
+
+    // Records the size of one of the day's main data structures for the
+    // memory report at the end of the phase. Nothing is done without --memory.
+    inline void note_footprint(const char* name, size_t entries, size_t bytes) {
+        if (MemoryReport::enabled()) {
+            MemoryReport::notes().push_back({ name, entries, bytes });
+        }
+    }
+    template<typename C>
+    void note_footprint(const char* name, const C& c) {
+        if (MemoryReport::enabled()) {
+            note_footprint(name, c.size(), footprint(c));
+        }
+    }
+
+    // The runner's --throughput. Cells a day's automata updated during the
+    // phase, which AutoTimer prints at its end as a rate of cells per second.
+    class Throughput {
+    public:
+        static bool& enabled() {
+            static bool on = false;
+            return on;
+        }
+
+        static uint64_t& cells() {
+            thread_local uint64_t n = 0;
+            return n;
+        }
+
+        static void print(std::ostream& os, const char* phase, double seconds) {
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+            os << std::fixed << std::setprecision(0);
+            os << "Throughput " << phase << ": " << cells() << " cells, " << (seconds > 0 ? cells() / seconds : 0.0) << " cells/sec" << std::endl;
+            cells() = 0;
+            os.flags(flags);
+            os.precision(precision);
+        }
+    };
+
+    inline void note_cells(uint64_t cells) {
+        Throughput::cells() += cells;
+    }
+
+    // Thrown by operator new once the heap would grow past the budget. It is
+    // a bad_alloc, so code already handling running out of memory handles it.
+    // The message is formatted up front, as nothing may allocate by then.
+    class MemoryBudgetExceeded : public std::bad_alloc {
+    private:
+        char what_[192];
+
+    public:
+        MemoryBudgetExceeded(size_t limit, int64_t live, size_t requested) {
+            const char* phase = current_phase();
+            std::snprintf(what_, sizeof(what_), "memory budget of %zu MiB exceeded%s%s: %lld MiB in use, %zu bytes more requested",
+                limit >> 20, phase ? " in " : "", phase ? phase : "", static_cast<long long>(live >> 20), requested);
+        }
+
+        const char* what() const noexcept override {
+            return what_;
+        }
+    };
+
+    // The runner's --memory-budget: a cap on the bytes live on the heap
+    // across all threads, charged and released by its operator new and
+    // delete. 0 is no cap. Blocks allocated before the cap was set are
+    // released too, so they are counted in from the start.
+    class MemoryBudget {
+    public:
+        static size_t& limit() {
+            static size_t bytes = 0;
+            return bytes;
+        }
+
+        // in_use is what the heap holds already
+        static void set(size_t bytes, size_t in_use) {
+            live().store(static_cast<int64_t>(in_use), std::memory_order_relaxed);
+            limit() = bytes;
+        }
+
+        static std::atomic<int64_t>& live() {
+            static std::atomic<int64_t> bytes{0};
+            return bytes;
+        }
+
+        // Charges bytes to the budget, throwing if that would go over it
+        static void charge(size_t bytes, size_t requested) {
+            const int64_t now = live().fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+            if (now > static_cast<int64_t>(limit())) {
+                live().fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+                throw MemoryBudgetExceeded(limit(), now - static_cast<int64_t>(bytes), requested);
+            }
+        }
+
+        static void release(size_t bytes) {
+            live().fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        }
+    };
+
+    // Seconds spent in each named phase of a solve (parse, part1, ...), in
+    // the order they ran. The runner installs one per benchmark iteration.
+    using PhaseTimes = std::vector<std::pair<std::string, double>>;
+
+    inline PhaseTimes*& phase_log() {
+        thread_local PhaseTimes* log = nullptr;
+        return log;
+    }
+
+    class ScopedPhaseLog {
+    private:
+        PhaseTimes* prev_;
+
+    public:
+        explicit ScopedPhaseLog(PhaseTimes& log)
+            : prev_(phase_log())
+        {
+            phase_log() = &log;
+        }
+
+        ~ScopedPhaseLog() {
+            phase_log() = prev_;
+        }
+
+        ScopedPhaseLog(const ScopedPhaseLog&) = delete;
+        ScopedPhaseLog& operator=(const ScopedPhaseLog&) = delete;
+    };
+
+    // Nanoseconds on the raw monotonic clock, which NTP never slews; cheap
+    // enough (vDSO, no syscall) to bracket every phase and inner search
+    inline uint64_t profile_clock() {
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    // Hardware counters for the calling thread, read through perf_event_open.
+    // Events the kernel or the machine will not give us (no PMU in a VM,
+    // perf_event_paranoid too high) are just left out of the report.
+    class PerfCounters {
+    public:
+        enum Event { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses, EventCount };
+        using Values = std::array<uint64_t, EventCount>;
+
+    private:
+        std::array<int, EventCount> fds_;
+
+    public:
+        PerfCounters() {
+            fds_.fill(-1);
+#ifdef __linux__
+            const std::array<std::pair<uint32_t, uint64_t>, EventCount> events = {{
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            }};
+            for (size_t e = 0; e < EventCount; e++) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = events[e].first;
+                attr.config = events[e].second;
+                // User space only, which paranoid level 2 still allows
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                fds_[e] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            }
+#endif
+        }
+
+        ~PerfCounters() {
+            for (const int fd : fds_) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        bool available(Event e) const {
+            return fds_[e] >= 0;
+        }
+
+        // Counts so far, scaled up if the kernel had to multiplex the counters
+        void read(Values& values) const {
+            for (size_t e = 0; e < EventCount; e++) {
+                uint64_t buf[3] = { 0, 0, 0 };
+                if (fds_[e] < 0 || ::read(fds_[e], buf, sizeof(buf)) != sizeof(buf)) {
+                    values[e] = 0;
+                } else if (buf[2] != 0 && buf[2] < buf[1]) {
+                    values[e] = static_cast<uint64_t>(static_cast<double>(buf[0]) * buf[1] / buf[2]);
+                } else {
+                    values[e] = buf[0];
+                }
+            }
+        }
+
+        static const char* name(size_t e) {
+            static const char* const names[EventCount] = { "cycles", "instr", "L1d miss", "LLC miss", "br miss" };
+            return names[e];
+        }
+
+        // Counters belong to the thread that opened them, so each thread gets its own
+        static const PerfCounters& for_thread() {
+            thread_local const PerfCounters counters;
+            return counters;
+        }
+    };
+
+    // Heap use of one thread, kept by the operator new and delete that
+    // runner.cpp defines once enabled() is set (the runner's --allocs).
+    // Memory allocated on one thread and freed on another counts against
+    // each, so live can go negative; peak is the most live at once since it
+    // was last reset. Work handed to aoc::parallel_for() workers counts on
+    // their threads, not the caller's.
+    class AllocCounts {
+    public:
+        uint64_t allocs;
+        uint64_t bytes;
+        int64_t live;
+        int64_t peak;
+
+        static bool& enabled() {
+            static bool on = false;
+            return on;
+        }
+
+        // Constant initialized, so safe to touch from operator new on any thread
+        static AllocCounts& for_thread() {
+            thread_local AllocCounts counts{};
+            return counts;
+        }
+
+        // requested is what was asked for, usable what the block really holds
+        void allocated(size_t requested, size_t usable) {
+            allocs++;
+            bytes += requested;
+            live += usable;
+            peak = std::max(peak, live);
+        }
+
+        void freed(size_t usable) {
+            live -= usable;
+        }
+    };
+
+    // Call tree of named scopes for one thread. Nothing is printed while
+    // timing; the runner merges the trees and reports once at the end.
+    class Profile {
+    public:
+        class Node {
+        public:
+            std::string name;
+            const char* key;
+            size_t parent;
+            std::vector<size_t> children;
+            uint64_t ns;
+            uint64_t calls;
+            PerfCounters::Values counts;
+            uint64_t allocs;
+            uint64_t alloc_bytes;
+            // Most heap in use at once above what was live on entry, over all calls
+            int64_t peak;
+
+            Node(std::string n, const char* k, size_t p)
+                : name(std::move(n))
+                , key(k)
+                , parent(p)
+                , ns(0)
+                , calls(0)
+                , counts()
+                , allocs(0)
+                , alloc_bytes(0)
+                , peak(0)
+            { }
+        };
+
+        // Where a scope started. allocs.peak holds the enclosing scope's peak
+        // while this one tracks its own.
+        class Mark {
+        public:
+            size_t node = 0;
+            uint64_t start = 0;
+            PerfCounters::Values counts = {};
+            AllocCounts allocs = {};
+        };
+
+    private:
+        std::vector<Node> nodes_;
+        size_t current_;
+        const PerfCounters* counters_;
+        bool use_counters_;
+        bool use_allocs_;
+        std::array<bool, PerfCounters::EventCount> available_;
+
+    public:
+        // With counters, every scope also reads the hardware counters of
+        // the thread it runs on, and with allocs its AllocCounts
+        explicit Profile(bool counters = false, bool allocs = false)
+            : current_(0)
+            , counters_(nullptr)
+            , use_counters_(counters)
+            , use_allocs_(allocs)
+            , available_()
+        {
+            nodes_.emplace_back("", nullptr, 0);
+        }
+
+        bool empty() const {
+            return nodes_.size() == 1;
+        }
+
+        const std::vector<Node>& nodes() const {
+            return nodes_;
+        }
+
+        // Names are usually literals, so the pointer compare nearly always hits
+        void enter(const char* name, Mark& mark) {
+            mark.node = child(current_, name);
+            current_ = mark.node;
+            if (use_counters_) {
+                if (!counters_) {
+                    counters_ = &PerfCounters::for_thread();
+                    for (size_t e = 0; e < PerfCounters::EventCount; e++) {
+                        available_[e] = counters_->available(static_cast<PerfCounters::Event>(e));
+                    }
+                }
+                counters_->read(mark.counts);
+            }
+            if (use_allocs_) {
+                auto& a = AllocCounts::for_thread();
+                mark.allocs = a;
+                a.peak = a.live;
+            }
+            mark.start = profile_clock();
+        }
+
+        void leave(const Mark& mark) {
+            const uint64_t end = profile_clock();
+            auto& n = nodes_[mark.node];
+            if (counters_) {
+                PerfCounters::Values counts;
+                counters_->read(counts);
+                for (size_t e = 0; e < PerfCounters::EventCount; e++) {
+                    n.counts[e] += counts[e] - mark.counts[e];
+                }
+            }
+            if (use_allocs_) {
+                auto& a = AllocCounts::for_thread();
+                n.allocs += a.allocs - mark.allocs.allocs;
+                n.alloc_bytes += a.bytes - mark.allocs.bytes;
+                n.peak = std::max(n.peak, a.peak - mark.allocs.live);
+                a.peak = std::max(a.peak, mark.allocs.peak);
+            }
+            n.ns += end - mark.start;
+            n.calls++;
+            current_ = n.parent;
+        }
+
+        // Graft other's tree under a new top level scope
+        void merge(const std::string& name, uint64_t ns, const Profile& other) {
+            const size_t dst = child(0, name.c_str());
+            nodes_[dst].key = nullptr;
+            nodes_[dst].ns += ns;
+            nodes_[dst].calls++;
+            use_counters_ = use_counters_ || other.use_counters_;
+            use_allocs_ = use_allocs_ || other.use_allocs_;
+            for (size_t e = 0; e < PerfCounters::EventCount; e++) {
+                available_[e] = available_[e] || other.available_[e];
+            }
+            merge(other, 0, dst);
+            // Top level counts are what the day's phases add up to
+            for (const auto c : other.nodes_[0].children) {
+                const auto& n = other.nodes_[c];
+                for (size_t e = 0; e < PerfCounters::EventCount; e++) {
+                    nodes_[dst].counts[e] += n.counts[e];
+                }
+                nodes_[dst].allocs += n.allocs;
+                nodes_[dst].alloc_bytes += n.alloc_bytes;
+                nodes_[dst].peak = std::max(nodes_[dst].peak, n.peak);
+            }
+        }
+
+        void report(std::ostream& os) const {
+            uint64_t total = 0;
+            for (const auto c : nodes_[0].children) {
+                total += nodes_[c].ns;
+            }
+
+            const bool counters = std::find(available_.begin(), available_.end(), true) != available_.end();
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+            os << std::left << std::setw(32) << "Profile (sec)" << std::right << std::setw(14) << "total" <<
+                std::setw(14) << "self" << std::setw(10) << "calls" << std::setw(8) << "%";
+            if (use_allocs_) {
+                os << std::setw(12) << "allocs" << std::setw(14) << "bytes" << std::setw(14) << "peak";
+            }
+            if (counters) {
+                for (size_t e = 0; e < PerfCounters::EventCount; e++) {
+                    os << std::setw(15) << PerfCounters::name(e);
+                    if (e == PerfCounters::Instructions) {
+                        os << std::setw(6) << "IPC";
+                    }
+                }
+            }
+            os << std::endl;
+            for (const auto c : nodes_[0].children) {
+                report(os, c, 0, total, counters);
+            }
+            if (use_counters_ && !counters) {
+                os << "Hardware counters unavailable (no PMU, or kernel.perf_event_paranoid too high)" << std::endl;
+            }
+            os.flags(flags);
+            os.precision(precision);
+        }
+
+    private:
+        size_t child(size_t parent, const char* name) {
+            for (const auto c : nodes_[parent].children) {
+                if (nodes_[c].key == name || nodes_[c].name == name) {
+                    return c;
+                }
+            }
+            nodes_.emplace_back(name, name, parent);
+            nodes_[parent].children.push_back(nodes_.size() - 1);
+            return nodes_.size() - 1;
+        }
+
+        void merge(const Profile& other, size_t from, size_t to) {
+            for (const auto c : other.nodes_[from].children) {
+                const auto& n = other.nodes_[c];
+                const size_t dst = child(to, n.name.c_str());
+                // The key pointed into other, which may not outlive us
+                nodes_[dst].key = nullptr;
+                nodes_[dst].ns += n.ns;
+                nodes_[dst].calls += n.calls;
+                for (size_t e = 0; e < PerfCounters::EventCount; e++) {
+                    nodes_[dst].counts[e] += n.counts[e];
+                }
+                nodes_[dst].allocs += n.allocs;
+                nodes_[dst].alloc_bytes += n.alloc_bytes;
+                nodes_[dst].peak = std::max(nodes_[dst].peak, n.peak);
+                merge(other, c, dst);
+            }
+        }
+
+        void report(std::ostream& os, size_t node, size_t depth, uint64_t total, bool counters) const {
+            const auto& n = nodes_[node];
+            uint64_t self = n.ns;
+            for (const auto c : n.children) {
+                self -= std::min(self, nodes_[c].ns);
+            }
+
+            os << std::left << std::setw(32) << (std::string(depth * 2, ' ') + n.name) << std::right <<
+                std::fixed << std::setprecision(9) <<
+                std::setw(14) << n.ns * 1e-9 << std::setw(14) << self * 1e-9 << std::setw(10) << n.calls <<
+                std::setprecision(1) << std::setw(7) << (total ? 100.0 * n.ns / total : 0.0) << "%";
+            if (use_allocs_) {
+                os << std::setw(12) << n.allocs << std::setw(14) << n.alloc_bytes << std::setw(14) << n.peak;
+            }
+            if (counters) {
+                for (size_t e = 0; e < PerfCounters::EventCount; e++) {
+                    if (available_[e]) {
+                        os << std::setw(15) << n.counts[e];
+                    } else {
+                        os << std::setw(15) << "n/a";
+                    }
+                    if (e == PerfCounters::Instructions) {
+                        const auto cycles = n.counts[PerfCounters::Cycles];
+                        os << std::setprecision(2) << std::setw(6);
+                        if (available_[PerfCounters::Cycles] && available_[PerfCounters::Instructions] && cycles) {
+                            os << static_cast<double>(n.counts[e]) / cycles;
+                        } else {
+                            os << "n/a";
+                        }
+                    }
+                }
+            }
+            os << std::endl;
+            for (const auto c : n.children) {
+                report(os, c, depth + 1, total, counters);
+            }
+        }
+    };
+
+    inline Profile*& active_profile() {
+        thread_local Profile* profile = nullptr;
+        return profile;
+    }
+
+    class ScopedProfile {
+    private:
+        Profile* prev_;
+
+    public:
+        explicit ScopedProfile(Profile& profile)
+            : prev_(active_profile())
+        {
+            active_profile() = &profile;
+        }
+
+        ~ScopedProfile() {
+            active_profile() = prev_;
+        }
+
+        ScopedProfile(const ScopedProfile&) = delete;
+        ScopedProfile& operator=(const ScopedProfile&) = delete;
+    };
+
+    // Times the enclosing block as a child of whatever scope is open. Costs a
+    // thread_local load and a branch when no profile is being collected.
+    class ProfileScope {
+    private:
+        Profile* profile_;
+        Profile::Mark mark_;
+
+    public:
+        explicit ProfileScope(const char* name)
+            : profile_(active_profile())
+        {
+            if (profile_) {
+                profile_->enter(name, mark_);
+            }
+        }
+
+        ~ProfileScope() {
+            if (profile_) {
+                profile_->leave(mark_);
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+    };
+
+#define AOC_PROFILE_CONCAT_(a, b) a##b
+#define AOC_PROFILE_CONCAT(a, b) AOC_PROFILE_CONCAT_(a, b)
+#define AOC_PROFILE_SCOPE(name) aoc::ProfileScope AOC_PROFILE_CONCAT(aoc_profile_scope_, __LINE__)(name)
+
+    class AutoTimer {
+    private:
+        uint64_t start_;
+        std::string name_;
+        const char* phase_;
+        uint64_t phase_start_;
+        Profile* profile_;
+        Profile::Mark phase_mark_;
+
+    public:
+        AutoTimer()
+            : start_(profile_clock())
+            , phase_(nullptr)
+            , phase_start_(0)
+            , profile_(active_profile())
+        { }
+
+        AutoTimer(const char *name)
+            : start_(profile_clock())
+            , name_(name)
+            , phase_(nullptr)
+            , phase_start_(0)
+            , profile_(active_profile())
+        { }
+
+        ~AutoTimer() {
+            end_phase();
+            calculate_time();
+        }
+
+        void elapsed() const {
+            calculate_time();
+        }
+
+        void reset() {
+            start_ = profile_clock();
+        }
+
+        // End the current phase, if any, and start timing the next one. Phases
+        // also open a profiler scope, so inner scopes nest under them.
+        void phase(const char* name) {
+            end_phase();
+            phase_ = name;
+            current_phase() = name;
+            if (profile_) {
+                profile_->enter(name, phase_mark_);
+            }
+            phase_start_ = profile_clock();
+        }
+
+    private:
+        void end_phase() {
+            if (!phase_) {
+                return;
+            }
+            const uint64_t ns = profile_clock() - phase_start_;
+            if (profile_) {
+                profile_->leave(phase_mark_);
+            }
+            auto* log = phase_log();
+            if (log) {
+                log->emplace_back(phase_, ns * 1e-9);
+            }
+            if (Throughput::enabled() && Throughput::cells()) {
+                Throughput::print(out(), phase_, ns * 1e-9);
+            }
+            Throughput::cells() = 0;
+            if (MemoryReport::enabled()) {
+                MemoryReport::print(out(), phase_);
+            }
+            current_phase() = nullptr;
+            phase_ = nullptr;
+        }
+
+        void calculate_time () const {
+            const double time_taken = (profile_clock() - start_) * 1e-9;
 
-            std::cout << "Elapsed" << (name_.empty() ? "" : " " + name_) << ": " << std::fixed << time_taken << std::setprecision(9) << " sec" << std::endl;
+            out() << "Elapsed" << (name_.empty() ? "" : " " + name_) << ": " << std::fixed << std::setprecision(9) << time_taken << " sec" << std::endl;
         }
 
     };
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "aoc21/helpers.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace aoc {
+
+    // Hash of an input's bytes, 8 at a time. Only used to tell inputs apart,
+    // not to guard against anyone crafting collisions.
+    inline uint64_t content_hash(const std::string_view s) {
+        uint64_t h = 0x9E3779B97F4A7C15ULL ^ s.size();
+        const auto mix = [&h](uint64_t w) {
+            h ^= w;
+            h *= 0xBF58476D1CE4E5B9ULL;
+            h ^= h >> 31;
+        };
+        size_t i = 0;
+        for (; i + 8 <= s.size(); i += 8) {
+            uint64_t w;
+            ::memcpy(&w, s.data() + i, 8);
+            mix(w);
+        }
+        if (i < s.size()) {
+            uint64_t w = 0;
+            ::memcpy(&w, s.data() + i, s.size() - i);
+            mix(w);
+        }
+        h ^= h >> 29;
+        h *= 0x94D049BB133111EBULL;
+        return h ^ (h >> 32);
+    }
+
+    // Read-only run of elements in a mapped cache file
+    template<typename T>
+    class CachedSection {
+    private:
+        const T* data_;
+        size_t size_;
+
+    public:
+        CachedSection(const T* data, size_t size)
+            : data_(data)
+            , size_(size)
+        { }
+
+        const T* begin() const { return data_; }
+        const T* end() const { return data_ + size_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        const T& operator[](size_t i) const { return data_[i]; }
+    };
+
+    // Opt-in cache of a day's parsed input. The day hands over its parsed
+    // form as flat vectors of trivially copyable elements, which are written
+    // to <dir>/<day>-<hash>.bin, and later runs on the same input map that
+    // file and read them back in place of parsing the text.
+    //
+    // The file is only used when its header matches the input's size and
+    // content hash, this layout's Format and the day's own version, which a
+    // day bumps whenever the elements it stores change. Anything else is a
+    // miss, and the file is rewritten after parsing.
+    //
+    // Off unless the runner's --parse-cache or $AOC_PARSE_CACHE names a
+    // directory, in which case construction costs a hash of the input.
+    class ParseCache {
+    public:
+        static constexpr uint32_t Format = 1;
+
+    private:
+        class Header {
+        public:
+            char magic[8];
+            uint32_t format;
+            uint32_t version;
+            uint64_t hash;
+            uint64_t input_size;
+            uint64_t sections;
+        };
+
+        class Section {
+        public:
+            uint64_t offset;
+            uint64_t count;
+            uint64_t element_size;
+        };
+
+        // A section add() copied out, waiting for store()
+        class Pending {
+        public:
+            uint64_t element_size;
+            std::string bytes;
+        };
+
+        static constexpr char Magic[8] = { 'A', 'O', 'C', 'P', 'A', 'R', 'S', 'E' };
+        static constexpr size_t Align = 16;
+
+        uint32_t version_;
+        uint64_t hash_;
+        uint64_t input_size_;
+        std::string path_;
+        MappedInput file_;
+        std::vector<Section> sections_;
+        std::vector<Pending> pending_;
+
+    public:
+        ParseCache(const std::string_view day, uint32_t version, const std::string_view input)
+            : version_(version)
+            , hash_(0)
+            , input_size_(input.size())
+        {
+            if (!enabled()) {
+                return;
+            }
+            hash_ = content_hash(input);
+            char name[32];
+            std::snprintf(name, sizeof(name), "-%016llx.bin", static_cast<unsigned long long>(hash_));
+            path_ = directory() + "/" + std::string(day) + name;
+        }
+
+        // Set by the runner's --parse-cache, else $AOC_PARSE_CACHE; empty is off
+        static std::string& directory() {
+            static std::string dir = []() {
+                const char* env = std::getenv("AOC_PARSE_CACHE");
+                return std::string(env ? env : "");
+            }();
+            return dir;
+        }
+
+        static bool enabled() {
+            return !directory().empty();
+        }
+
+        const std::string& path() const {
+            return path_;
+        }
+
+        // Maps the file for this input. False on a miss: no cache, no file,
+        // or one written for another input, layout or version.
+        bool load() {
+            if (path_.empty()) {
+                return false;
+            }
+            try {
+                file_.open(path_.c_str());
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+
+            const auto bytes = file_.remaining();
+            Header h;
+            if (bytes.size() < sizeof(h)) {
+                return miss();
+            }
+            ::memcpy(&h, bytes.data(), sizeof(h));
+            if (::memcmp(h.magic, Magic, sizeof(Magic)) != 0 || h.format != Format || h.version != version_ ||
+                h.hash != hash_ || h.input_size != input_size_ ||
+                h.sections > (bytes.size() - sizeof(h)) / sizeof(Section)) {
+                return miss();
+            }
+
+            sections_.resize(h.sections);
+            ::memcpy(sections_.data(), bytes.data() + sizeof(h), h.sections * sizeof(Section));
+            for (const auto& s : sections_) {
+                if (s.offset % Align != 0 || s.offset > bytes.size() ||
+                    (s.element_size && s.count > (bytes.size() - s.offset) / s.element_size)) {
+                    return miss();
+                }
+            }
+            return true;
+        }
+
+        size_t sections() const {
+            return sections_.size();
+        }
+
+        // The i-th section load() found, as Ts
+        template<typename T>
+        CachedSection<T> section(size_t i) const {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be cached");
+            static_assert(alignof(T) <= Align, "Cached elements are aligned to 16 bytes at most");
+            if (i >= sections_.size() || sections_[i].element_size != sizeof(T)) {
+                throw std::runtime_error("Parse cache " + path_ + " has no section " + std::to_string(i) + " of " +
+                    std::to_string(sizeof(T)) + " byte elements, bump the day's cache version");
+            }
+            const auto bytes = file_.remaining();
+            return CachedSection<T>(reinterpret_cast<const T*>(bytes.data() + sections_[i].offset), sections_[i].count);
+        }
+
+        // Queues v as the next section for store()
+        template<typename T>
+        void add(const std::vector<T>& v) {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be cached");
+            static_assert(alignof(T) <= Align, "Cached elements are aligned to 16 bytes at most");
+            if (path_.empty()) {
+                return;
+            }
+            pending_.push_back(Pending{ sizeof(T), std::string(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T)) });
+        }
+
+        // Writes the sections queued with add(). A cache that can not be
+        // written is only a slower next run, so failures are ignored.
+        void store() {
+            if (path_.empty()) {
+                return;
+            }
+
+            Header h;
+            ::memcpy(h.magic, Magic, sizeof(Magic));
+            h.format = Format;
+            h.version = version_;
+            h.hash = hash_;
+            h.input_size = input_size_;
+            h.sections = pending_.size();
+
+            std::vector<Section> table;
+            uint64_t offset = round_up(sizeof(h) + pending_.size() * sizeof(Section));
+            for (const auto& p : pending_) {
+                table.push_back(Section{ offset, p.bytes.size() / p.element_size, p.element_size });
+                offset = round_up(offset + p.bytes.size());
+            }
+
+            // Written aside and renamed into place, so concurrent runs on the
+            // same input never see half a file
+            static std::atomic<unsigned> serial{0};
+            const std::string tmp = path_ + ".tmp" + std::to_string(::getpid()) + "." + std::to_string(serial++);
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+                out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(Section));
+                uint64_t at = sizeof(h) + table.size() * sizeof(Section);
+                for (size_t i = 0; i < pending_.size(); i++) {
+                    pad(out, at, table[i].offset);
+                    out.write(pending_[i].bytes.data(), static_cast<std::streamsize>(pending_[i].bytes.size()));
+                    at = table[i].offset + pending_[i].bytes.size();
+                }
+                if (!out) {
+                    std::remove(tmp.c_str());
+                    return;
+                }
+            }
+            if (std::rename(tmp.c_str(), path_.c_str()) != 0) {
+                std::remove(tmp.c_str());
+            }
+            pending_.clear();
+        }
+
+    private:
+        bool miss() {
+            file_.close();
+            sections_.clear();
+            return false;
+        }
+
+        static uint64_t round_up(uint64_t n) {
+            return (n + Align - 1) / Align * Align;
+        }
+
+        static void pad(std::ofstream& out, uint64_t at, uint64_t to) {
+            static const char zeros[Align] = { };
+            out.write(zeros, static_cast<std::streamsize>(to - at));
+        }
+    };
+};
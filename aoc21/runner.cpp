@@ -0,0 +1,813 @@
+#include "aoc21/helpers.h"
+#include "aoc21/bench.h"
+#include "aoc21/parse_cache.h"
+#include "aoc21/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <malloc.h>
+
+/*
+ * main() for every binary. A day's own binary has exactly one solver
+ * registered and keeps its original command line:
+ *
+ *   DayN [run options] <input> [args...]
+ *   DayN [run options] [--jobs N] --batch <input|dir|@list> ...
+ *
+ * --batch solves every input given, up to --jobs of them at once on a thread
+ * pool, and prints each one's results under its path, in the order given. A
+ * directory stands for the files in it, sorted by name, and @list for the
+ * paths in a manifest file, one per line.
+ *
+ * aoc_all links every day and runs any subset of them in one process:
+ *
+ *   aoc_all [--inputs <dir>] [--sample] [--jobs N] [--timings <file>] [run options] [day|first-last ...]
+ *
+ * With more than one job, days are handed to worker threads longest first,
+ * going by the run times recorded in the timings file, and each day's output
+ * is buffered so it still prints in day order.
+ *
+ * Bench options (--bench, --warmup N, --iterations N, --json <file>) run each
+ * day repeatedly, one at a time, and report order statistics for the total
+ * and for every phase the day marks with AutoTimer::phase().
+ *
+ * --baseline <file> compares each day's median total time and answers with
+ * an earlier --json run, scaled by how fast this machine runs a fixed
+ * calibration workload, and fails on wrong answers or on slowdowns beyond
+ * --threshold (a fraction, default 0.5) that are also larger than
+ * --min-delta seconds. A day that looks slower is timed once more first. aoc_all given no days runs the days in the baseline.
+ *
+ * --compare <file> just prints each day's speedup over an earlier --json run,
+ * for comparing builds on one machine.
+ *
+ * --threads sets the size of the pool aoc::parallel_for() runs on, falling
+ * back to $AOC_THREADS and then to one thread per core. With 1 the loops run
+ * inline on the day's own thread, in order.
+ *
+ * --parse-cache <dir> lets the days that support it (4, 19, 22 and 24) save
+ * their parsed input to dir, keyed by a hash of its content, and load that
+ * rather than parse the text on later runs. $AOC_PARSE_CACHE does the same.
+ *
+ * --isa=<level> (or --isa <level>) pins the variant of every dispatched
+ * kernel to scalar, sse4.2, avx2 or avx512 instead of the widest the CPU
+ * supports, to compare them on one machine. Levels the CPU lacks are refused.
+ *
+ * --profile collects the tree of phases and AOC_PROFILE_SCOPE()s each day
+ * runs through and prints it, summed over all runs, once everything is done.
+ * --counters adds hardware counters (cycles, instructions, cache and branch
+ * misses) to every scope in that tree, where perf_event_open allows it.
+ * --allocs adds the heap allocations, bytes and peak live bytes of each
+ * scope, counted by the operator new and delete below.
+ *
+ * --memory prints the resident set and the sizes of the day's main data
+ * structures at the end of every phase. --memory-budget <MiB> caps the heap:
+ * operator new throws aoc::MemoryBudgetExceeded instead of going past it, and
+ * the day fails with that as its error.
+ *
+ * --throughput prints how many cells the automata of days 11, 20 and 25
+ * updated in every phase, and how many per second.
+ */
+
+// Every binary's heap goes through these. Unless --allocs turned counting on
+// or --memory-budget set a cap they cost a couple of branches over plain
+// malloc and free. Usable sizes are what live bytes are kept in, as that is
+// what delete can find out again.
+static void* account_new(void* p, size_t n) {
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  if (aoc::AllocCounts::enabled() || aoc::MemoryBudget::limit()) {
+    const size_t usable = ::malloc_usable_size(p);
+    if (aoc::MemoryBudget::limit()) {
+      try {
+        aoc::MemoryBudget::charge(usable, n);
+      } catch (...) {
+        std::free(p);
+        throw;
+      }
+    }
+    if (aoc::AllocCounts::enabled()) {
+      aoc::AllocCounts::for_thread().allocated(n, usable);
+    }
+  }
+  return p;
+}
+
+void* operator new(size_t n) {
+  return account_new(std::malloc(n ? n : 1), n);
+}
+
+void* operator new(size_t n, std::align_val_t align) {
+  const size_t a = static_cast<size_t>(align);
+  return account_new(std::aligned_alloc(a, (std::max<size_t>(n, 1) + a - 1) / a * a), n);
+}
+
+void operator delete(void* p) noexcept {
+  if (p && (aoc::AllocCounts::enabled() || aoc::MemoryBudget::limit())) {
+    const size_t usable = ::malloc_usable_size(p);
+    if (aoc::MemoryBudget::limit()) {
+      aoc::MemoryBudget::release(usable);
+    }
+    if (aoc::AllocCounts::enabled()) {
+      aoc::AllocCounts::for_thread().freed(usable);
+    }
+  }
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  operator delete(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  operator delete(p);
+}
+
+#ifndef AOC_INPUTS_DIR
+#define AOC_INPUTS_DIR "inputs"
+#endif
+
+namespace {
+  void usage(const char* name, bool single_day) {
+    if (single_day) {
+      std::cerr << "Usage: " << name << " [options] <input> [args...]" << std::endl;
+      std::cerr << "       " << name << " [options] [--jobs <n>] --batch <input|dir|@list> ..." << std::endl;
+      std::cerr << "  --batch           Solve every input given, printing the results of each in turn" << std::endl;
+      std::cerr << "  --jobs <n>        Inputs to solve at once with --batch (default: one per core)" << std::endl;
+    } else {
+      std::cerr << "Usage: " << name << " [options] [day|first-last ...]" << std::endl;
+      std::cerr << "  --inputs <dir>    Directory holding DayN.txt (default: " << AOC_INPUTS_DIR << ")" << std::endl;
+      std::cerr << "  --sample          Use DayNSample.txt instead of DayN.txt, checking the answers of days that solve it at compile time" << std::endl;
+      std::cerr << "  --jobs <n>        Days to run at once (default: one per core)" << std::endl;
+      std::cerr << "  --timings <f>     Read and update per day run times, used to schedule longest first" << std::endl;
+    }
+    std::cerr << "  --bench           Run repeatedly and report min/median/p90/p99/stddev per phase" << std::endl;
+    std::cerr << "  --warmup <n>      Untimed runs before measuring (default: 1)" << std::endl;
+    std::cerr << "  --iterations <n>  Measured runs (default: 10)" << std::endl;
+    std::cerr << "  --json <f>        Also write the benchmark results to f, implies --bench" << std::endl;
+    std::cerr << "  --baseline <f>    Fail on answers or median times that differ from a --json file, implies --bench" << std::endl;
+    std::cerr << "  --compare <f>     Print the speedup of each day's median time over a --json file, implies --bench" << std::endl;
+    std::cerr << "  --threshold <x>   Allowed slowdown against the baseline, as a fraction (default: 0.5)" << std::endl;
+    std::cerr << "  --min-delta <s>   Ignore slowdowns smaller than this many seconds (default: 0.00002)" << std::endl;
+    std::cerr << "  --threads <n>     Threads for aoc::parallel_for within a day, 1 runs it inline (default: $AOC_THREADS or one per core)" << std::endl;
+    std::cerr << "  --isa <level>     Run the vector kernels at scalar, sse4.2, avx2 or avx512 (default: the widest this CPU has, " << aoc::isa::name(aoc::isa::detected()) << ")" << std::endl;
+    std::cerr << "  --parse-cache <dir>  Keep the parsed form of inputs in dir and reuse it while the input is unchanged (default: $AOC_PARSE_CACHE)" << std::endl;
+    std::cerr << "  --profile         Print the tree of timed scopes at exit" << std::endl;
+    std::cerr << "  --counters        Add hardware counters to the profile, implies --profile" << std::endl;
+    std::cerr << "  --allocs          Add heap allocations, bytes and peak live bytes to the profile, implies --profile" << std::endl;
+    std::cerr << "  --memory          Print the resident set and main data structure sizes after every phase" << std::endl;
+    std::cerr << "  --memory-budget <mib>  Fail a day cleanly rather than let the heap grow past this many MiB" << std::endl;
+    std::cerr << "  --throughput      Print the cells per second of the automaton days after every phase" << std::endl;
+    if (!single_day) {
+      std::cerr << "With no days given, every registered day is run." << std::endl;
+    }
+  }
+
+  // Accepts 7, Day7 or 3-9
+  bool parse_days(std::string_view arg, std::set<int>& days) {
+    if (arg.substr(0, 3) == "Day") {
+      arg.remove_prefix(3);
+    }
+
+    int first = 0;
+    int last = 0;
+    const auto dash = arg.find('-');
+    if (dash == std::string_view::npos) {
+      if (aoc::parse_integer(arg, first) != std::errc()) {
+        return false;
+      }
+      last = first;
+    } else if (aoc::parse_integer(arg.substr(0, dash), first) != std::errc() ||
+        aoc::parse_integer(arg.substr(dash + 1), last) != std::errc()) {
+      return false;
+    }
+
+    for (int d = first; d <= last; d++) {
+      days.insert(d);
+    }
+    return first <= last;
+  }
+
+  // args[0] is the program name, as in argv
+  int run_day(aoc::SolveFunction fn, std::vector<std::string> args, aoc::Profile* profile = nullptr, std::ostream& errors = std::cerr) {
+    std::optional<aoc::ScopedProfile> scope;
+    if (profile) {
+      scope.emplace(*profile);
+    }
+
+    std::vector<char*> argv;
+    for (auto& a : args) {
+      argv.push_back(&a[0]);
+    }
+    argv.push_back(nullptr);
+
+    try {
+      return fn(static_cast<int>(args.size()), argv.data());
+    } catch (const std::exception& e) {
+      errors << args[0] << ": " << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  // Options shared by aoc_all and the day binaries
+  class RunOptions {
+  public:
+    bool enabled = false;
+    size_t warmup = 1;
+    size_t iterations = 10;
+    std::string json_path;
+    std::string baseline_path;
+    std::string compare_path;
+    aoc::RegressionCheck check;
+    bool profile = false;
+    bool counters = false;
+    bool allocs = false;
+
+    // Consumes argv[i] (and its value) if it is a run option
+    bool parse(int argc, char** argv, int& i, bool& ok) {
+      const std::string_view arg(argv[i]);
+      if (arg == "--profile") {
+        profile = true;
+      } else if (arg == "--counters") {
+        profile = true;
+        counters = true;
+      } else if (arg == "--allocs") {
+        profile = true;
+        allocs = true;
+        aoc::AllocCounts::enabled() = true;
+      } else if (arg == "--memory") {
+        aoc::MemoryReport::enabled() = true;
+      } else if (arg == "--throughput") {
+        aoc::Throughput::enabled() = true;
+      } else if (arg == "--memory-budget" && i + 1 < argc) {
+        size_t mib = 0;
+        ok = aoc::parse_integer(argv[++i], mib) == std::errc() && mib > 0;
+        const auto heap = ::mallinfo2();
+        aoc::MemoryBudget::set(mib << 20, heap.uordblks + heap.hblkhd);
+      } else if (arg == "--bench") {
+        enabled = true;
+      } else if (arg == "--warmup" && i + 1 < argc) {
+        ok = aoc::parse_integer(argv[++i], warmup) == std::errc();
+      } else if (arg == "--iterations" && i + 1 < argc) {
+        ok = aoc::parse_integer(argv[++i], iterations) == std::errc() && iterations > 0;
+      } else if (arg == "--json" && i + 1 < argc) {
+        enabled = true;
+        json_path = argv[++i];
+      } else if (arg.substr(0, 6) == "--isa=" || (arg == "--isa" && i + 1 < argc)) {
+        aoc::isa::Level level;
+        ok = aoc::isa::parse(arg.size() > 6 ? arg.substr(6) : std::string_view(argv[++i]), level);
+        try {
+          if (ok) {
+            aoc::isa::select(level);
+          }
+        } catch (const std::exception& e) {
+          std::cerr << e.what() << std::endl;
+          ok = false;
+        }
+      } else if (arg == "--parse-cache" && i + 1 < argc) {
+        std::error_code ec;
+        std::filesystem::create_directories(argv[++i], ec);
+        ok = !ec;
+        aoc::ParseCache::directory() = argv[i];
+      } else if (arg == "--threads" && i + 1 < argc) {
+        size_t threads = 0;
+        ok = aoc::parse_integer(argv[++i], threads) == std::errc() && threads > 0;
+        aoc::ThreadPool::set_threads(threads);
+      } else if (arg == "--baseline" && i + 1 < argc) {
+        enabled = true;
+        baseline_path = argv[++i];
+      } else if (arg == "--compare" && i + 1 < argc) {
+        enabled = true;
+        compare_path = argv[++i];
+      } else if (arg == "--threshold" && i + 1 < argc) {
+        ok = parse_seconds(argv[++i], check.threshold);
+      } else if (arg == "--min-delta" && i + 1 < argc) {
+        ok = parse_seconds(argv[++i], check.min_delta);
+      } else {
+        return false;
+      }
+      return true;
+    }
+
+  private:
+    static bool parse_seconds(const char* arg, double& value) {
+      char* end = nullptr;
+      value = std::strtod(arg, &end);
+      return end != arg && *end == '\0' && value >= 0;
+    }
+  };
+
+  // Warm-up runs print nothing; the output of the last measured run is kept
+  aoc::BenchResult bench_day(int day, aoc::SolveFunction fn, const std::vector<std::string>& args, const RunOptions& opts, aoc::Profile* profile) {
+    aoc::BenchResult result(day, args.size() > 1 ? args[1] : std::string(), opts.warmup);
+    for (size_t i = 0; i < opts.warmup; i++) {
+      std::ostringstream discard;
+      aoc::ScopedOutput o(discard);
+      result.rc = run_day(fn, args);
+    }
+
+    for (size_t i = 0; i < opts.iterations && result.rc == 0; i++) {
+      std::ostringstream output;
+      aoc::PhaseTimes phases;
+      aoc::Profile scopes(opts.counters, opts.allocs);
+      const auto start = std::chrono::steady_clock::now();
+      {
+        aoc::ScopedOutput o(output);
+        aoc::ScopedPhaseLog log(phases);
+        result.rc = run_day(fn, args, profile ? &scopes : nullptr);
+      }
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+      phases.emplace_back("total", std::chrono::duration<double>(elapsed).count());
+      if (profile) {
+        profile->merge("Day" + std::to_string(day), std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), scopes);
+      }
+      result.samples.add(phases);
+      result.output = output.str();
+    }
+    return result;
+  }
+
+  // Days slower than the baseline get a second round of runs, and are
+  // judged on the median of both. Load errors are left to report_bench().
+  template<typename Runs>
+  void retime_slower(const Runs& runs, std::vector<aoc::BenchResult>& results, const RunOptions& opts) {
+    if (opts.baseline_path.empty()) {
+      return;
+    }
+    aoc::Baseline baseline;
+    try {
+      baseline = aoc::Baseline::load(opts.baseline_path);
+    } catch (const std::exception&) {
+      return;
+    }
+
+    const double speed = aoc::RegressionCheck::speed(baseline, aoc::calibrate());
+    for (size_t i = 0; i < results.size(); i++) {
+      auto& r = results[i];
+      const auto it = baseline.days.find(r.day);
+      if (r.rc != 0 || it == baseline.days.end() || !opts.check.timing(r, it->second, speed).slower) {
+        continue;
+      }
+      auto again = bench_day(r.day, runs[i].fn, runs[i].args(), opts, nullptr);
+      r.samples.merge(again.samples);
+      r.rc = again.rc;
+    }
+  }
+
+  int report_bench(const std::vector<aoc::BenchResult>& results, const RunOptions& opts, bool headers) {
+    int rc = 0;
+    for (const auto& r : results) {
+      if (headers) {
+        std::cout << "Day" << r.day << std::endl;
+      }
+      std::cout << r.output;
+      aoc::print_bench_report(std::cout, r);
+      if (headers) {
+        std::cout << std::endl;
+      }
+      rc = rc ? rc : r.rc;
+    }
+
+    if (!opts.compare_path.empty()) {
+      try {
+        aoc::print_comparison(std::cout, results, aoc::Baseline::load(opts.compare_path));
+      } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+      }
+    }
+
+    if (opts.json_path.empty() && opts.baseline_path.empty()) {
+      return rc;
+    }
+
+    const double calibration = aoc::calibrate();
+    if (!opts.json_path.empty()) {
+      std::ofstream f(opts.json_path);
+      if (!f) {
+        std::cerr << "Cannot write " << opts.json_path << std::endl;
+        return 1;
+      }
+      aoc::write_bench_json(f, results, calibration);
+    }
+
+    if (!opts.baseline_path.empty()) {
+      try {
+        const auto baseline = aoc::Baseline::load(opts.baseline_path);
+        if (!opts.check.run(std::cout, results, baseline, calibration)) {
+          rc = rc ? rc : 1;
+        }
+      } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+      }
+    }
+    return rc;
+  }
+
+  // Seconds each day took on previous runs, one "day seconds" pair per line
+  using Timings = std::map<int, double>;
+
+  Timings load_timings(const std::string& path) {
+    Timings t;
+    std::ifstream f(path);
+    int day;
+    double seconds;
+    while (f >> day >> seconds) {
+      t[day] = seconds;
+    }
+    return t;
+  }
+
+  void save_timings(const std::string& path, const Timings& t) {
+    std::ofstream f(path);
+    for (const auto& [day, seconds] : t) {
+      f << day << " " << seconds << std::endl;
+    }
+  }
+
+  class DayRun {
+  public:
+    int day;
+    aoc::SolveFunction fn;
+    std::string input;
+    std::ostringstream output;
+    aoc::Profile profile;
+    int rc;
+    double seconds;
+
+    DayRun(int d, aoc::SolveFunction f, std::string in)
+      : day(d)
+      , fn(f)
+      , input(std::move(in))
+      , rc(0)
+      , seconds(0)
+    { }
+
+    std::vector<std::string> args() const {
+      return { "Day" + std::to_string(day), input };
+    }
+
+    void run(const RunOptions& opts) {
+      profile = aoc::Profile(opts.counters, opts.allocs);
+      const auto start = std::chrono::steady_clock::now();
+      rc = run_day(fn, args(), opts.profile ? &profile : nullptr);
+      seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+  };
+
+  // Run every day on up to jobs threads, longest expected first, and print
+  // each day's buffered output in day order as soon as it and all the days
+  // before it are done.
+  void run_parallel(std::vector<DayRun>& runs, size_t jobs, const Timings& history, const RunOptions& opts) {
+    std::vector<size_t> order(runs.size());
+    std::iota(order.begin(), order.end(), 0);
+    // Days we have no history for go first, as they could be anything
+    const auto expected = [&](const DayRun& r) {
+      const auto it = history.find(r.day);
+      return it == history.end() ? std::numeric_limits<double>::infinity() : it->second;
+    };
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return expected(runs[a]) > expected(runs[b]);
+    });
+
+    std::vector<std::promise<void>> done(runs.size());
+    std::atomic<size_t> next{0};
+    const auto worker = [&]() {
+      for (size_t i = next++; i < order.size(); i = next++) {
+        auto& r = runs[order[i]];
+        {
+          aoc::ScopedOutput o(r.output);
+          r.run(opts);
+        }
+        done[order[i]].set_value();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::min(jobs, runs.size()); i++) {
+      threads.emplace_back(worker);
+    }
+
+    for (size_t i = 0; i < runs.size(); i++) {
+      done[i].get_future().wait();
+      std::cout << "Day" << runs[i].day << std::endl;
+      std::cout << runs[i].output.str() << std::endl;
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  // Files named by a --batch argument: the file itself, the files in a
+  // directory sorted by name, or the paths listed in an @manifest, one per
+  // line and relative to the manifest. Blank lines and # comments are skipped.
+  void expand_input(const std::string& arg, std::vector<std::string>& inputs) {
+    namespace fs = std::filesystem;
+    if (arg.size() > 1 && arg[0] == '@') {
+      const fs::path manifest(arg.substr(1));
+      std::ifstream f(manifest);
+      if (!f) {
+        throw std::runtime_error("Cannot read " + manifest.string());
+      }
+      std::string line;
+      while (std::getline(f, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+          continue;
+        }
+        const auto path = line.substr(first, line.find_last_not_of(" \t\r") + 1 - first);
+        inputs.push_back((manifest.parent_path() / fs::path(path)).string());
+      }
+    } else if (fs::is_directory(arg)) {
+      std::vector<std::string> files;
+      for (const auto& entry : fs::directory_iterator(arg)) {
+        if (entry.is_regular_file()) {
+          files.push_back(entry.path().string());
+        }
+      }
+      std::sort(files.begin(), files.end());
+      inputs.insert(inputs.end(), files.begin(), files.end());
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+
+  class BatchRun {
+  public:
+    std::string input;
+    std::ostringstream output;
+    std::ostringstream errors;
+    aoc::Profile profile;
+    int rc = 0;
+    double seconds = 0;
+  };
+
+  // Solves the inputs on a pool of jobs threads. Results are printed a window
+  // of inputs at a time, in input order, so a long batch shows progress
+  // without holding every input's output until the end.
+  int run_batch(int day, aoc::SolveFunction fn, const std::string& name, const std::vector<std::string>& inputs, size_t jobs, const RunOptions& opts) {
+    aoc::ThreadPool pool(jobs);
+    const size_t window = 16 * pool.size();
+    aoc::Profile profile;
+    size_t failed = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < inputs.size(); first += window) {
+      std::vector<BatchRun> runs(std::min(window, inputs.size() - first));
+      pool.parallel_for(0, runs.size(), [&](size_t i) {
+        auto& r = runs[i];
+        r.input = inputs[first + i];
+        r.profile = aoc::Profile(opts.counters, opts.allocs);
+        aoc::ScopedOutput o(r.output);
+        const auto t = std::chrono::steady_clock::now();
+        r.rc = run_day(fn, { name, r.input }, opts.profile ? &r.profile : nullptr, r.errors);
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+      }, 1);
+
+      for (const auto& r : runs) {
+        std::cout << r.input << std::endl;
+        std::cout << r.output.str() << std::endl;
+        std::cerr << r.errors.str();
+        failed += r.rc != 0;
+        if (opts.profile) {
+          profile.merge("Day" + std::to_string(day), static_cast<uint64_t>(r.seconds * 1e9), r.profile);
+        }
+      }
+    }
+    const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (opts.profile) {
+      profile.report(std::cout);
+    }
+    std::cout << "Inputs: " << inputs.size() << ", failed: " << failed << std::endl;
+    std::cout << "Elapsed total: " << std::fixed << std::setprecision(9) << total << " sec" << std::endl;
+    return failed ? 1 : 0;
+  }
+
+  // A day's own binary: run options first, everything else goes to the day
+  int run_single(int day, aoc::SolveFunction fn, int argc, char** argv) {
+    RunOptions bench;
+    bool batch = false;
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> args{ argv[0] };
+    for (int i = 1; i < argc; i++) {
+      const std::string_view arg(argv[i]);
+      bool ok = true;
+      if (arg == "--batch") {
+        batch = true;
+      } else if (arg == "--jobs" || arg == "-j") {
+        ok = i + 1 < argc && aoc::parse_integer(argv[++i], jobs) == std::errc() && jobs > 0;
+      } else if (!bench.parse(argc, argv, i, ok)) {
+        args.emplace_back(argv[i]);
+      }
+      if (!ok) {
+        usage(argv[0], true);
+        return 1;
+      }
+    }
+
+    if (batch) {
+      // Benchmarking wants one input at a time, on a quiet machine
+      if (bench.enabled || args.size() < 2) {
+        usage(argv[0], true);
+        return 1;
+      }
+      std::vector<std::string> inputs;
+      try {
+        for (size_t i = 1; i < args.size(); i++) {
+          expand_input(args[i], inputs);
+        }
+      } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+      }
+      return run_batch(day, fn, args[0], inputs, jobs, bench);
+    }
+
+    aoc::Profile profile;
+    int rc;
+    if (bench.enabled) {
+      rc = report_bench({ bench_day(day, fn, args, bench, bench.profile ? &profile : nullptr) }, bench, false);
+    } else {
+      aoc::Profile scopes(bench.counters, bench.allocs);
+      const auto start = aoc::profile_clock();
+      rc = run_day(fn, args, bench.profile ? &scopes : nullptr);
+      profile.merge("Day" + std::to_string(day), aoc::profile_clock() - start, scopes);
+    }
+
+    if (bench.profile) {
+      profile.report(std::cout);
+    }
+    return rc;
+  }
+};
+
+int main(int argc, char** argv) {
+  const auto& solvers = aoc::solvers();
+
+  if (solvers.size() == 1) {
+    return run_single(solvers.begin()->first, solvers.begin()->second, argc, argv);
+  }
+
+  std::string inputs = AOC_INPUTS_DIR;
+  std::string suffix = ".txt";
+  std::string timings_path;
+  size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+  RunOptions bench;
+  std::set<int> days;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg(argv[i]);
+    bool ok = true;
+    if (bench.parse(argc, argv, i, ok)) {
+      if (!ok) {
+        usage(argv[0], false);
+        return 1;
+      }
+    } else if (arg == "--inputs" && i + 1 < argc) {
+      inputs = argv[++i];
+    } else if (arg == "--sample") {
+      suffix = "Sample.txt";
+    } else if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+      if (aoc::parse_integer(argv[++i], jobs) != std::errc() || jobs == 0) {
+        usage(argv[0], false);
+        return 1;
+      }
+    } else if (arg == "--timings" && i + 1 < argc) {
+      timings_path = argv[++i];
+    } else if (!parse_days(arg, days)) {
+      usage(argv[0], false);
+      return 1;
+    }
+  }
+
+  // A baseline check covers the days the baseline was recorded for
+  if (days.empty() && !bench.baseline_path.empty()) {
+    try {
+      for (const auto& [day, _] : aoc::Baseline::load(bench.baseline_path).days) {
+        (void)_;
+        days.insert(day);
+      }
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  if (days.empty()) {
+    for (const auto& [day, _] : solvers) {
+      (void)_;
+      days.insert(day);
+    }
+  }
+
+  int rc = 0;
+  std::vector<DayRun> runs;
+  runs.reserve(days.size());
+  for (const auto day : days) {
+    const auto it = solvers.find(day);
+    if (it == solvers.end()) {
+      std::cerr << "Day" << day << " is not registered" << std::endl;
+      rc = 1;
+      continue;
+    }
+    runs.emplace_back(day, it->second, inputs + "/Day" + std::to_string(day) + suffix);
+  }
+
+  // Days are measured one at a time so they do not compete for cores or cache
+  if (bench.enabled) {
+    std::vector<aoc::BenchResult> results;
+    aoc::Profile profile;
+    for (const auto& r : runs) {
+      results.push_back(bench_day(r.day, r.fn, r.args(), bench, bench.profile ? &profile : nullptr));
+    }
+    retime_slower(runs, results, bench);
+    const int bench_rc = report_bench(results, bench, true);
+    if (bench.profile) {
+      profile.report(std::cout);
+    }
+    return rc ? rc : bench_rc;
+  }
+
+  Timings timings;
+  if (!timings_path.empty()) {
+    timings = load_timings(timings_path);
+  }
+
+  // Days with a constexpr solver know their sample answers already
+  const bool check_samples = suffix != ".txt";
+
+  const auto start = std::chrono::steady_clock::now();
+  if (jobs > 1 && runs.size() > 1) {
+    run_parallel(runs, jobs, timings, bench);
+  } else {
+    for (auto& r : runs) {
+      std::cout << "Day" << r.day << std::endl;
+      if (check_samples) {
+        {
+          aoc::ScopedOutput o(r.output);
+          r.run(bench);
+        }
+        std::cout << r.output.str();
+      } else {
+        r.run(bench);
+      }
+      std::cout << std::endl;
+    }
+  }
+  const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  for (const auto& r : runs) {
+    rc = rc ? rc : r.rc;
+    // Smooth out the odd noisy run
+    const auto it = timings.find(r.day);
+    timings[r.day] = (it == timings.end()) ? r.seconds : (it->second + r.seconds) / 2;
+  }
+  // Sample runs say nothing about how long the real inputs take
+  if (!timings_path.empty() && suffix == ".txt") {
+    save_timings(timings_path, timings);
+  }
+
+  if (check_samples) {
+    for (const auto& r : runs) {
+      const auto it = aoc::sample_answers().find(r.day);
+      if (it == aoc::sample_answers().end() || r.rc) {
+        continue;
+      }
+      std::ostringstream expected;
+      expected << "Part 1: " << it->second.first << std::endl << "Part 2: " << it->second.second << std::endl;
+      if (aoc::answers(r.output.str()) != expected.str()) {
+        std::cerr << "Day" << r.day << ": answers differ from the ones worked out at compile time" << std::endl;
+        rc = rc ? rc : 1;
+      }
+    }
+  }
+
+  if (bench.profile) {
+    aoc::Profile profile;
+    for (const auto& r : runs) {
+      profile.merge("Day" + std::to_string(r.day), static_cast<uint64_t>(r.seconds * 1e9), r.profile);
+    }
+    profile.report(std::cout);
+  }
+
+  if (runs.size() > 1) {
+    std::cout << "Elapsed total: " << std::fixed << std::setprecision(9) << total << " sec" << std::endl;
+  }
+
+  return rc;
+}
@@ -0,0 +1,340 @@
+#pragma once
+
+#include "aoc21/helpers.h"
+
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aoc {
+
+    // Searches over graphs the caller describes with callbacks: nodes are any
+    // copyable value, and expand(node, ..., push) hands push() the edges out
+    // of a node. Visited sets and queues are passed in so their storage can
+    // be reused from one search to the next.
+    namespace search {
+
+        // Visited set over the dense indices [0, n), a bit each
+        class BitVisited {
+        private:
+            std::vector<uint64_t> words_;
+
+        public:
+            BitVisited() = default;
+
+            explicit BitVisited(size_t n)
+                : words_((n + 63) / 64, 0)
+            { }
+
+            void resize(size_t n) {
+                words_.resize((n + 63) / 64, 0);
+            }
+
+            void clear() {
+                std::fill(words_.begin(), words_.end(), 0);
+            }
+
+            bool contains(size_t i) const {
+                return (words_[i >> 6] >> (i & 63)) & 1;
+            }
+
+            // True the first time i is inserted
+            bool insert(size_t i) {
+                uint64_t& w = words_[i >> 6];
+                const uint64_t bit = uint64_t(1) << (i & 63);
+                const bool fresh = !(w & bit);
+                w |= bit;
+                return fresh;
+            }
+
+            size_t memory() const {
+                return words_.capacity() * sizeof(uint64_t);
+            }
+        };
+
+        // Visited set over [0, n) that clears in O(1): an index is in the set
+        // while its stamp is the current epoch. For many searches over the
+        // same nodes that each touch only a few of them.
+        class EpochVisited {
+        private:
+            std::vector<uint32_t> stamps_;
+            uint32_t epoch_ = 1;
+
+        public:
+            EpochVisited() = default;
+
+            explicit EpochVisited(size_t n)
+                : stamps_(n, 0)
+            { }
+
+            void resize(size_t n) {
+                stamps_.resize(n, 0);
+            }
+
+            void clear() {
+                if (++epoch_ == 0) {
+                    std::fill(stamps_.begin(), stamps_.end(), 0);
+                    epoch_ = 1;
+                }
+            }
+
+            bool contains(size_t i) const {
+                return stamps_[i] == epoch_;
+            }
+
+            bool insert(size_t i) {
+                if (stamps_[i] == epoch_) {
+                    return false;
+                }
+                stamps_[i] = epoch_;
+                return true;
+            }
+
+            size_t memory() const {
+                return stamps_.capacity() * sizeof(uint32_t);
+            }
+        };
+
+        namespace detail {
+            // Marks n visited, true the first time. Takes the sets above, any
+            // set whose insert() returns a pair (FlatHashSet, std::set), or a
+            // callable, for sets keyed by something other than the node.
+            template<typename Visited, typename Node>
+            bool first_visit(Visited& visited, const Node& n) {
+                if constexpr (std::is_invocable_r_v<bool, Visited&, const Node&>) {
+                    return visited(n);
+                } else {
+                    const auto r = visited.insert(n);
+                    if constexpr (std::is_same_v<std::decay_t<decltype(r)>, bool>) {
+                        return r;
+                    } else {
+                        return r.second;
+                    }
+                }
+            }
+        };
+
+        // Monotone priority queue for small integer keys (Dial's buckets): a
+        // ring of one bucket per key, covering the last key popped up to span
+        // more. Keys pushed must lie in that range, which suits Dijkstra with
+        // edge weights of at most span.
+        template<typename T>
+        class DialQueue {
+        private:
+            std::vector<std::vector<T>> buckets_;
+            uint64_t mask_;
+            uint64_t current_;
+            size_t size_;
+
+        public:
+            explicit DialQueue(size_t span)
+                : mask_(0)
+                , current_(0)
+                , size_(0)
+            {
+                size_t n = 1;
+                while (n <= span) {
+                    n <<= 1;
+                }
+                buckets_.resize(n);
+                mask_ = n - 1;
+            }
+
+            bool empty() const { return size_ == 0; }
+            size_t size() const { return size_; }
+
+            void clear() {
+                for (auto& b : buckets_) {
+                    b.clear();
+                }
+                current_ = 0;
+                size_ = 0;
+            }
+
+            void push(uint64_t key, T value) {
+                assert(key >= current_ && key - current_ <= mask_);
+                buckets_[key & mask_].push_back(std::move(value));
+                size_++;
+            }
+
+            // A value with the smallest key
+            T pop() {
+                assert(!empty());
+                while (buckets_[current_ & mask_].empty()) {
+                    current_++;
+                }
+                auto& b = buckets_[current_ & mask_];
+                T value = std::move(b.back());
+                b.pop_back();
+                size_--;
+                return value;
+            }
+        };
+
+        // Monotone priority queue for any 64 bit keys (a radix heap). Bucket
+        // i > 0 holds the keys whose highest bit differing from the last key
+        // popped is bit i - 1, so a value moves to a lower bucket at most 64
+        // times before it is popped. Keys pushed must not be below the last
+        // key popped.
+        template<typename T>
+        class RadixHeap {
+        private:
+            using Bucket = std::pmr::vector<std::pair<uint64_t, T>>;
+
+            std::vector<Bucket> buckets_;
+            uint64_t last_;
+            size_t size_;
+
+            static size_t bucket_of(uint64_t key, uint64_t last) {
+                return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+            }
+
+        public:
+            explicit RadixHeap(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+                : last_(0)
+                , size_(0)
+            {
+                buckets_.reserve(65);
+                for (size_t i = 0; i < 65; i++) {
+                    buckets_.emplace_back(resource);
+                }
+            }
+
+            bool empty() const { return size_ == 0; }
+            size_t size() const { return size_; }
+
+            void clear() {
+                for (auto& b : buckets_) {
+                    b.clear();
+                }
+                last_ = 0;
+                size_ = 0;
+            }
+
+            void push(uint64_t key, T value) {
+                assert(key >= last_);
+                buckets_[bucket_of(key, last_)].emplace_back(key, std::move(value));
+                size_++;
+            }
+
+            T pop() {
+                assert(!empty());
+                if (buckets_[0].empty()) {
+                    size_t i = 1;
+                    while (buckets_[i].empty()) {
+                        i++;
+                    }
+                    // Everything in bucket i redistributes around its smallest key
+                    auto& from = buckets_[i];
+                    last_ = std::min_element(from.begin(), from.end(), [](const auto& a, const auto& b) { return a.first < b.first; })->first;
+                    for (auto& e : from) {
+                        buckets_[bucket_of(e.first, last_)].push_back(std::move(e));
+                    }
+                    from.clear();
+                }
+                T value = std::move(buckets_[0].back().second);
+                buckets_[0].pop_back();
+                size_--;
+                return value;
+            }
+        };
+
+        // A node reached at cost, as the best first searches queue it
+        template<typename Node, typename Cost>
+        class Entry {
+        public:
+            Node node;
+            Cost cost;
+        };
+
+        // A* from start, returning the cost of the first node goal() accepts,
+        // or nothing if none can be reached. expand(node, cost, push) calls
+        // push(next, step) for every edge out of node. Nodes come off the
+        // queue, a DialQueue or RadixHeap of Entry<Node, Cost>, by cost plus
+        // heuristic(node), and are expanded the first time only. The
+        // heuristic must be consistent, never falling by more than the step
+        // taken, both to find the cheapest path and to keep the keys pushed
+        // to a monotone queue from going backwards.
+        template<typename Cost, typename Node, typename Queue, typename Visited, typename Expand, typename Goal, typename Heuristic>
+        std::optional<Cost> astar(const Node& start, Queue& queue, Visited& visited, Expand&& expand, Goal&& goal, Heuristic&& heuristic) {
+            queue.clear();
+            queue.push(static_cast<uint64_t>(heuristic(start)), Entry<Node, Cost>{ start, Cost() });
+            while (!queue.empty()) {
+                const auto e = queue.pop();
+                if (!detail::first_visit(visited, e.node)) {
+                    continue;
+                }
+                if (goal(e.node)) {
+                    return e.cost;
+                }
+                expand(e.node, e.cost, [&](const Node& next, Cost step) {
+                    const Cost cost = e.cost + step;
+                    queue.push(static_cast<uint64_t>(cost + heuristic(next)), Entry<Node, Cost>{ next, cost });
+                });
+            }
+            return std::nullopt;
+        }
+
+        // A* with no heuristic
+        template<typename Cost, typename Node, typename Queue, typename Visited, typename Expand, typename Goal>
+        std::optional<Cost> dijkstra(const Node& start, Queue& queue, Visited& visited, Expand&& expand, Goal&& goal) {
+            return astar<Cost>(start, queue, visited, std::forward<Expand>(expand), std::forward<Goal>(goal), [](const Node&) { return Cost(); });
+        }
+
+        // Breadth first search, keeping its queue from one search to the next
+        template<typename Node>
+        class Bfs {
+        private:
+            std::vector<Node> queue_;
+
+        public:
+            // Visits every node reachable from start that visited has not seen,
+            // nearest first. expand(node, push) calls push(next) for each
+            // neighbour worth going to. Returns how many nodes were visited.
+            template<typename Visited, typename Expand>
+            size_t run(const Node& start, Visited& visited, Expand&& expand) {
+                queue_.clear();
+                if (!detail::first_visit(visited, start)) {
+                    return 0;
+                }
+                queue_.push_back(start);
+                for (size_t head = 0; head < queue_.size(); head++) {
+                    const Node n = queue_[head];
+                    expand(n, [&](const Node& next) {
+                        if (detail::first_visit(visited, next)) {
+                            queue_.push_back(next);
+                        }
+                    });
+                }
+                return queue_.size();
+            }
+
+            // The nodes the last run() visited, in the order it did
+            const std::vector<Node>& order() const {
+                return queue_;
+            }
+        };
+
+        // Number of paths from start that end at a node goal() accepts, in a
+        // graph with no cycles: expand(node, push) calls push(next) for each
+        // edge, and a path stops at the first goal it reaches. memo, a map
+        // from node to count, keeps what is known between calls.
+        template<typename Node, typename Memo, typename Expand, typename Goal>
+        uint64_t count_paths(const Node& start, Memo& memo, Expand&& expand, Goal&& goal) {
+            if (goal(start)) {
+                return 1;
+            }
+            if (const auto it = memo.find(start); it != memo.end()) {
+                return it->second;
+            }
+            uint64_t paths = 0;
+            expand(start, [&](const Node& next) {
+                paths += count_paths(next, memo, expand, goal);
+            });
+            memo.emplace(start, paths);
+            return paths;
+        }
+    };
+};
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "aoc21/helpers.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace aoc {
+
+    // Fixed set of worker threads, each with its own deque of tasks. A worker
+    // takes from the back of its own deque and, when that is empty, steals
+    // from the front of the others'. A thread waiting on parallel_for() or
+    // parallel_reduce() runs tasks too, so they can nest, and sleeps once
+    // there are none left to run until the last of its own finish.
+    //
+    // Tasks run on other threads, so they must not print through aoc::out()
+    // or mark phases; do that from the calling thread.
+    class ThreadPool {
+    private:
+        using Task = std::function<void()>;
+
+        class Worker {
+        public:
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+
+        // Tasks left in a parallel_for(), and the first exception one threw.
+        // pending only changes under lock, so the waiter cannot see it reach
+        // zero and destroy the group while the last task still holds it.
+        class Group {
+        public:
+            std::atomic<size_t> pending{0};
+            std::mutex lock;
+            std::condition_variable done;
+            std::exception_ptr error;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> threads_;
+        std::mutex sleep_lock_;
+        std::condition_variable wake_;
+        std::atomic<size_t> queued_;
+        std::atomic<size_t> next_;
+        bool stop_;
+
+        // The pool the current thread works for, and its index there
+        class Self {
+        public:
+            const ThreadPool* pool = nullptr;
+            size_t index = SIZE_MAX;
+        };
+
+        static Self& current() {
+            static thread_local Self self;
+            return self;
+        }
+
+        // SIZE_MAX unless the current thread is one of this pool's workers
+        size_t worker_index() const {
+            return current().pool == this ? current().index : SIZE_MAX;
+        }
+
+    public:
+        // threads counts the calling thread, so ThreadPool(1) starts no
+        // threads at all and runs everything inline, in index order
+        explicit ThreadPool(size_t threads)
+            : queued_(0)
+            , next_(0)
+            , stop_(false)
+        {
+            threads = std::max<size_t>(threads, 1);
+            for (size_t i = 0; i < threads - 1; i++) {
+                workers_.push_back(std::make_unique<Worker>());
+            }
+            for (size_t i = 0; i < workers_.size(); i++) {
+                threads_.emplace_back([this, i]() { work(i); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> l(sleep_lock_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto& t : threads_) {
+                t.join();
+            }
+        }
+
+        size_t size() const {
+            return workers_.size() + 1;
+        }
+
+        // Threads for the shared pool: set_threads() (the runner's --threads)
+        // if called, else $AOC_THREADS, else one per core
+        static size_t& configured_threads() {
+            static size_t threads = 0;
+            return threads;
+        }
+
+        static void set_threads(size_t threads) {
+            configured_threads() = threads;
+        }
+
+        static size_t default_threads() {
+            if (configured_threads()) {
+                return configured_threads();
+            }
+            if (const char* env = std::getenv("AOC_THREADS")) {
+                size_t n = 0;
+                if (parse_integer(std::string_view(env), n) == std::errc() && n > 0) {
+                    return n;
+                }
+            }
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Shared by every day, created on first use
+        static ThreadPool& global() {
+            static ThreadPool pool(default_threads());
+            return pool;
+        }
+
+        // Calls body(i) for every i in [begin, end), in chunks of grain
+        // indices. The default grain gives at most 256 chunks.
+        template<typename Fn>
+        void parallel_for(size_t begin, size_t end, Fn&& body, size_t grain = 0) {
+            if (begin >= end) {
+                return;
+            }
+            grain = grain ? grain : default_grain(end - begin);
+
+            if (workers_.empty() || end - begin <= grain) {
+                for (size_t i = begin; i < end; i++) {
+                    body(i);
+                }
+                return;
+            }
+
+            Group group;
+            group.pending = (end - begin + grain - 1) / grain;
+            for (size_t lo = begin; lo < end; lo += grain) {
+                const size_t hi = std::min(end, lo + grain);
+                push([&group, &body, lo, hi]() {
+                    try {
+                        for (size_t i = lo; i < hi; i++) {
+                            body(i);
+                        }
+                    } catch (...) {
+                        std::lock_guard<std::mutex> l(group.lock);
+                        if (!group.error) {
+                            group.error = std::current_exception();
+                        }
+                    }
+                    std::lock_guard<std::mutex> l(group.lock);
+                    if (--group.pending == 0) {
+                        group.done.notify_all();
+                    }
+                });
+            }
+            wait(group);
+        }
+
+        // Folds map(i) over [begin, end) with reduce, starting from init. The
+        // chunks depend only on the range and grain, and their results are
+        // combined in index order, so the answer is the same for any number
+        // of threads even when reduce is not associative (floating point).
+        template<typename T, typename Map, typename Reduce>
+        T parallel_reduce(size_t begin, size_t end, T init, Map&& map, Reduce&& reduce, size_t grain = 0) {
+            if (begin >= end) {
+                return init;
+            }
+            grain = grain ? grain : default_grain(end - begin);
+
+            const size_t chunks = (end - begin + grain - 1) / grain;
+            std::vector<std::optional<T>> partial(chunks);
+            parallel_for(0, chunks, [&](size_t c) {
+                const size_t lo = begin + c * grain;
+                const size_t hi = std::min(end, lo + grain);
+                T acc = map(lo);
+                for (size_t i = lo + 1; i < hi; i++) {
+                    acc = reduce(std::move(acc), map(i));
+                }
+                partial[c] = std::move(acc);
+            }, 1);
+
+            for (auto& p : partial) {
+                init = reduce(std::move(init), std::move(*p));
+            }
+            return init;
+        }
+
+    private:
+        static size_t default_grain(size_t n) {
+            return std::max<size_t>(1, (n + 255) / 256);
+        }
+
+        // Onto the calling worker's own deque, or spread over all of them
+        void push(Task task) {
+            const size_t self = worker_index();
+            const size_t i = self < workers_.size() ? self : next_++ % workers_.size();
+            {
+                std::lock_guard<std::mutex> l(workers_[i]->lock);
+                workers_[i]->tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> l(sleep_lock_);
+                queued_++;
+            }
+            wake_.notify_one();
+        }
+
+        // Own deque from the back first, then steal from the front of the rest
+        bool try_run(size_t self) {
+            Task task;
+            const size_t n = workers_.size();
+            for (size_t k = 0; k < n && !task; k++) {
+                const size_t i = self < n ? (self + k) % n : k;
+                std::lock_guard<std::mutex> l(workers_[i]->lock);
+                auto& q = workers_[i]->tasks;
+                if (q.empty()) {
+                    continue;
+                }
+                if (i == self) {
+                    task = std::move(q.back());
+                    q.pop_back();
+                } else {
+                    task = std::move(q.front());
+                    q.pop_front();
+                }
+            }
+
+            if (!task) {
+                return false;
+            }
+            queued_--;
+            task();
+            return true;
+        }
+
+        // Runs queued tasks while there are any, then sleeps until the group
+        // is done. Whatever is still pending is running on another thread.
+        void wait(Group& group) {
+            const size_t self = worker_index();
+            while (group.pending > 0) {
+                if (try_run(self)) {
+                    continue;
+                }
+                std::unique_lock<std::mutex> l(group.lock);
+                group.done.wait(l, [this, &group]() { return group.pending == 0 || queued_ > 0; });
+            }
+            std::lock_guard<std::mutex> l(group.lock);
+            if (group.error) {
+                std::rethrow_exception(group.error);
+            }
+        }
+
+        void work(size_t self) {
+            current() = Self{ this, self };
+            while (true) {
+                if (try_run(self)) {
+                    continue;
+                }
+                std::unique_lock<std::mutex> l(sleep_lock_);
+                wake_.wait(l, [this]() { return stop_ || queued_ > 0; });
+                if (stop_) {
+                    return;
+                }
+            }
+        }
+    };
+
+    template<typename Fn>
+    void parallel_for(size_t begin, size_t end, Fn&& body, size_t grain = 0) {
+        ThreadPool::global().parallel_for(begin, end, std::forward<Fn>(body), grain);
+    }
+
+    template<typename T, typename Map, typename Reduce>
+    T parallel_reduce(size_t begin, size_t end, T init, Map&& map, Reduce&& reduce, size_t grain = 0) {
+        return ThreadPool::global().parallel_reduce(begin, end, std::move(init), std::forward<Map>(map), std::forward<Reduce>(reduce), grain);
+    }
+};
@@ -7,6 +7,7 @@ BUILD_DIR="${ROOT_DIR}/build"
 BUILDS_ROOT_DIR="${BUILD_DIR}/private/builds"
 
 BUILD_TYPE=RelWithDebInfo
+PGO=""
 
 if [[ $# > 0 ]]; then
     case "${1}" in
@@ -23,6 +24,11 @@ if [[ $# > 0 ]]; then
             echo "Running Release build..."
 	    BUILD_TYPE=RelWithDebInfo
             ;;
+        pgo)
+            echo "Running profile guided build..."
+	    BUILD_TYPE=RelWithDebInfo
+	    PGO=1
+            ;;
 	    new)
             shift
             if [[ $# = 0 ]]; then
@@ -34,18 +40,14 @@ if [[ $# > 0 ]]; then
             echo "Setting up new day in ${new_day}"
             mkdir -p "${new_day}"
             cp "${ROOT_DIR}/template"/* "${new_day}/"
+            sed -i.bak "s/AOC_REGISTER_DAY(0,/AOC_REGISTER_DAY($1,/" "${new_day}/main.cpp" && rm "${new_day}/main.cpp.bak"
             touch "${ROOT_DIR}/inputs/Day${1}.txt" "${ROOT_DIR}/inputs/Day${1}Sample.txt"
             exit 0
             ;;
         run)
             shift
             if [[ $# = 0 ]]; then
-                for f in ${BUILD_DIR}/bin/Day*; do
-                    day=$(basename "${f}")
-                    echo ${day}
-                    ${f} ${ROOT_DIR}/inputs/${day}.txt
-                    echo
-                done
+                ${BUILD_DIR}/bin/aoc_all --inputs "${ROOT_DIR}/inputs" --timings "${BUILD_DIR}/timings.txt"
             else
                 ${BUILD_DIR}/bin/Day${1} ${ROOT_DIR}/inputs/Day${1}.txt
             fi
@@ -56,6 +58,7 @@ if [[ $# > 0 ]]; then
             echo "  clean     - Clean build output"
             echo "  release   - builds release, coverage and asan targets"
             echo "  debug     - (default) Disable optimizations and enable debug options"
+            echo "  pgo       - release, then a -march=native LTO build trained on inputs/, and their timings"
             echo "  new [num] - Prepare for a new day from an empty template"
             echo "  run (day) - Run the executables, optionally run specific day"
             exit 1
@@ -77,3 +80,42 @@ cmake ${THIS_CMAKE_ARGS} "${ROOT_DIR}" -DCMAKE_BUILD_TYPE="${BUILD_TYPE}"
 ${BUILD_CMD}
 cmake --install . --prefix "${BUILD_DIR}"
 
+if [[ -n "${PGO}" ]]; then
+    # Instrumented and optimized builds share a directory, as GCC names
+    # profiles after the object files they belong to
+    PGO_BUILD_DIR="${BUILDS_ROOT_DIR}/pgo"
+    PGO_PROFILE_DIR="${PGO_BUILD_DIR}/profile"
+    # Day24 takes two to three minutes a run, so training on it and timing
+    # both builds would add half an hour or more; it is left out, and the
+    # output says so
+    PGO_DAYS="1-23 25"
+    RELEASE_JSON="${BUILD_DIR}/bench-release.json"
+    PGO_JSON="${BUILD_DIR}/bench-pgo.json"
+
+    mkdir -p "${PGO_BUILD_DIR}"
+    cd "${PGO_BUILD_DIR}"
+    rm -rf "${PGO_PROFILE_DIR}"
+
+    echo "Building instrumented binaries..."
+    cmake ${THIS_CMAKE_ARGS} "${ROOT_DIR}" -DCMAKE_BUILD_TYPE="${BUILD_TYPE}" -DAOC_ARCH=native \
+        -DAOC_PGO=generate -DAOC_PGO_DIR="${PGO_PROFILE_DIR}"
+    cmake --build . --target aoc_all
+
+    echo "Training on ${ROOT_DIR}/inputs, without Day24, which takes minutes..."
+    ./aoc_all --inputs "${ROOT_DIR}/inputs" --jobs 1 ${PGO_DAYS} > /dev/null
+    if compgen -G "${PGO_PROFILE_DIR}/*.profraw" > /dev/null; then
+        llvm-profdata merge -o "${PGO_PROFILE_DIR}/default.profdata" "${PGO_PROFILE_DIR}"/*.profraw
+    fi
+
+    echo "Building with profiles..."
+    cmake ${THIS_CMAKE_ARGS} "${ROOT_DIR}" -DAOC_PGO=use
+    cmake --build . --clean-first
+
+    cmake --install . --prefix "${BUILD_DIR}"
+
+    echo "Benchmarking ${BUILD_TYPE} against PGO, without Day24..."
+    "${THIS_BUILD_DIR}/aoc_all" --inputs "${ROOT_DIR}/inputs" --iterations 5 --json "${RELEASE_JSON}" ${PGO_DAYS} > /dev/null
+    ./aoc_all --inputs "${ROOT_DIR}/inputs" --iterations 5 --json "${PGO_JSON}" --compare "${RELEASE_JSON}" ${PGO_DAYS} \
+        | sed -n '/^day  /,$p'
+
+fi
@@ -0,0 +1,37 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/build/private/builds/RelWithDebInfo
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(perf_inputs "/root/repo/build/private/builds/RelWithDebInfo/aoc_all" "--inputs" "/root/repo/inputs" "--baseline" "/root/repo/perf/baseline.json" "--warmup" "1" "--iterations" "3" "--threshold" "0.5" "--min-delta" "0.01")
+set_tests_properties(perf_inputs PROPERTIES  LABELS "perf" RUN_SERIAL "TRUE" TIMEOUT "1800" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;107;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(perf_generate_x10 "/root/repo/build/private/builds/RelWithDebInfo/gen_inputs" "--seed" "2021" "--scale" "10" "--out" "/root/repo/build/private/builds/RelWithDebInfo/perf_inputs_x10")
+set_tests_properties(perf_generate_x10 PROPERTIES  FIXTURES_SETUP "perf_x10" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;116;add_test;/root/repo/CMakeLists.txt;0;")
+add_test(perf_inputs_x10 "/root/repo/build/private/builds/RelWithDebInfo/aoc_all" "--inputs" "/root/repo/build/private/builds/RelWithDebInfo/perf_inputs_x10" "--baseline" "/root/repo/perf/baseline_x10.json" "--warmup" "1" "--iterations" "3" "--threshold" "0.5" "--min-delta" "0.01")
+set_tests_properties(perf_inputs_x10 PROPERTIES  FIXTURES_REQUIRED "perf_x10" LABELS "perf" RUN_SERIAL "TRUE" TIMEOUT "1800" _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;120;add_test;/root/repo/CMakeLists.txt;0;")
+subdirs("Day1")
+subdirs("Day10")
+subdirs("Day11")
+subdirs("Day12")
+subdirs("Day13")
+subdirs("Day14")
+subdirs("Day15")
+subdirs("Day16")
+subdirs("Day17")
+subdirs("Day18")
+subdirs("Day19")
+subdirs("Day2")
+subdirs("Day20")
+subdirs("Day21")
+subdirs("Day22")
+subdirs("Day23")
+subdirs("Day24")
+subdirs("Day25")
+subdirs("Day3")
+subdirs("Day4")
+subdirs("Day5")
+subdirs("Day6")
+subdirs("Day7")
+subdirs("Day8")
+subdirs("Day9")
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day1"
+  "Day1.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day1.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day17"
+  "Day17.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day17.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
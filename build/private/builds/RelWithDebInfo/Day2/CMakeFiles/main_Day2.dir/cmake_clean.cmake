@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day2"
+  "Day2.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day2.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
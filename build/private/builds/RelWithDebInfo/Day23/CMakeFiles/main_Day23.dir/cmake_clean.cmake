@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day23"
+  "Day23.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day23.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day8"
+  "Day8.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day8.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
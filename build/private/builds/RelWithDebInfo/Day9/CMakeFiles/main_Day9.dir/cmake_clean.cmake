@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day9"
+  "Day9.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day9.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,116 @@
+# Install script for directory: /root/repo
+
+# Set the install prefix
+if(NOT DEFINED CMAKE_INSTALL_PREFIX)
+  set(CMAKE_INSTALL_PREFIX "/usr/local")
+endif()
+string(REGEX REPLACE "/$" "" CMAKE_INSTALL_PREFIX "${CMAKE_INSTALL_PREFIX}")
+
+# Set the install configuration name.
+if(NOT DEFINED CMAKE_INSTALL_CONFIG_NAME)
+  if(BUILD_TYPE)
+    string(REGEX REPLACE "^[^A-Za-z0-9_]+" ""
+           CMAKE_INSTALL_CONFIG_NAME "${BUILD_TYPE}")
+  else()
+    set(CMAKE_INSTALL_CONFIG_NAME "RelWithDebInfo")
+  endif()
+  message(STATUS "Install configuration: \"${CMAKE_INSTALL_CONFIG_NAME}\"")
+endif()
+
+# Set the component getting installed.
+if(NOT CMAKE_INSTALL_COMPONENT)
+  if(COMPONENT)
+    message(STATUS "Install component: \"${COMPONENT}\"")
+    set(CMAKE_INSTALL_COMPONENT "${COMPONENT}")
+  else()
+    set(CMAKE_INSTALL_COMPONENT)
+  endif()
+endif()
+
+# Install shared libraries without execute permission?
+if(NOT DEFINED CMAKE_INSTALL_SO_NO_EXE)
+  set(CMAKE_INSTALL_SO_NO_EXE "1")
+endif()
+
+# Is this installation the result of a crosscompile?
+if(NOT DEFINED CMAKE_CROSSCOMPILING)
+  set(CMAKE_CROSSCOMPILING "FALSE")
+endif()
+
+# Set default install directory permissions.
+if(NOT DEFINED CMAKE_OBJDUMP)
+  set(CMAKE_OBJDUMP "/usr/bin/objdump")
+endif()
+
+if(CMAKE_INSTALL_COMPONENT STREQUAL "Unspecified" OR NOT CMAKE_INSTALL_COMPONENT)
+  if(EXISTS "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/aoc_all" AND
+     NOT IS_SYMLINK "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/aoc_all")
+    file(RPATH_CHECK
+         FILE "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/aoc_all"
+         RPATH "")
+  endif()
+  file(INSTALL DESTINATION "${CMAKE_INSTALL_PREFIX}/bin" TYPE EXECUTABLE FILES "/root/repo/build/private/builds/RelWithDebInfo/aoc_all")
+  if(EXISTS "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/aoc_all" AND
+     NOT IS_SYMLINK "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/aoc_all")
+    if(CMAKE_INSTALL_DO_STRIP)
+      execute_process(COMMAND "/usr/bin/strip" "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/aoc_all")
+    endif()
+  endif()
+endif()
+
+if(CMAKE_INSTALL_COMPONENT STREQUAL "Unspecified" OR NOT CMAKE_INSTALL_COMPONENT)
+  if(EXISTS "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/gen_inputs" AND
+     NOT IS_SYMLINK "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/gen_inputs")
+    file(RPATH_CHECK
+         FILE "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/gen_inputs"
+         RPATH "")
+  endif()
+  file(INSTALL DESTINATION "${CMAKE_INSTALL_PREFIX}/bin" TYPE EXECUTABLE FILES "/root/repo/build/private/builds/RelWithDebInfo/gen_inputs")
+  if(EXISTS "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/gen_inputs" AND
+     NOT IS_SYMLINK "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/gen_inputs")
+    if(CMAKE_INSTALL_DO_STRIP)
+      execute_process(COMMAND "/usr/bin/strip" "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}/bin/gen_inputs")
+    endif()
+  endif()
+endif()
+
+if(NOT CMAKE_INSTALL_LOCAL_ONLY)
+  # Include the install script for each subdirectory.
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day1/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day10/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day11/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day12/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day13/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day14/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day15/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day16/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day17/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day18/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day19/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day2/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day20/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day21/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day22/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day23/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day24/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day25/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day3/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day4/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day5/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day6/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day7/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day8/cmake_install.cmake")
+  include("/root/repo/build/private/builds/RelWithDebInfo/Day9/cmake_install.cmake")
+
+endif()
+
+if(CMAKE_INSTALL_COMPONENT)
+  set(CMAKE_INSTALL_MANIFEST "install_manifest_${CMAKE_INSTALL_COMPONENT}.txt")
+else()
+  set(CMAKE_INSTALL_MANIFEST "install_manifest.txt")
+endif()
+
+string(REPLACE ";" "\n" CMAKE_INSTALL_MANIFEST_CONTENT
+       "${CMAKE_INSTALL_MANIFEST_FILES}")
+file(WRITE "/root/repo/build/private/builds/RelWithDebInfo/${CMAKE_INSTALL_MANIFEST}"
+     "${CMAKE_INSTALL_MANIFEST_CONTENT}")
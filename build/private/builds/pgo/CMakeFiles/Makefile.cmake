@@ -0,0 +1,157 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "/root/repo/Day1/CMakeLists.txt"
+  "/root/repo/Day10/CMakeLists.txt"
+  "/root/repo/Day11/CMakeLists.txt"
+  "/root/repo/Day12/CMakeLists.txt"
+  "/root/repo/Day13/CMakeLists.txt"
+  "/root/repo/Day14/CMakeLists.txt"
+  "/root/repo/Day15/CMakeLists.txt"
+  "/root/repo/Day16/CMakeLists.txt"
+  "/root/repo/Day17/CMakeLists.txt"
+  "/root/repo/Day18/CMakeLists.txt"
+  "/root/repo/Day19/CMakeLists.txt"
+  "/root/repo/Day2/CMakeLists.txt"
+  "/root/repo/Day20/CMakeLists.txt"
+  "/root/repo/Day21/CMakeLists.txt"
+  "/root/repo/Day22/CMakeLists.txt"
+  "/root/repo/Day23/CMakeLists.txt"
+  "/root/repo/Day24/CMakeLists.txt"
+  "/root/repo/Day25/CMakeLists.txt"
+  "/root/repo/Day3/CMakeLists.txt"
+  "/root/repo/Day4/CMakeLists.txt"
+  "/root/repo/Day5/CMakeLists.txt"
+  "/root/repo/Day6/CMakeLists.txt"
+  "/root/repo/Day7/CMakeLists.txt"
+  "/root/repo/Day8/CMakeLists.txt"
+  "/root/repo/Day9/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day1/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day10/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day11/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day12/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day13/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day14/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day15/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day16/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day17/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day18/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day19/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day2/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day20/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day21/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day22/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day23/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day24/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day25/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day3/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day4/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day5/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day6/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day7/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day8/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "Day9/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/aoc_runner.dir/DependInfo.cmake"
+  "CMakeFiles/aoc_all.dir/DependInfo.cmake"
+  "CMakeFiles/gen_inputs.dir/DependInfo.cmake"
+  "CMakeFiles/scaled_inputs.dir/DependInfo.cmake"
+  "Day1/CMakeFiles/day_Day1.dir/DependInfo.cmake"
+  "Day1/CMakeFiles/main_Day1.dir/DependInfo.cmake"
+  "Day10/CMakeFiles/day_Day10.dir/DependInfo.cmake"
+  "Day10/CMakeFiles/main_Day10.dir/DependInfo.cmake"
+  "Day11/CMakeFiles/day_Day11.dir/DependInfo.cmake"
+  "Day11/CMakeFiles/main_Day11.dir/DependInfo.cmake"
+  "Day12/CMakeFiles/day_Day12.dir/DependInfo.cmake"
+  "Day12/CMakeFiles/main_Day12.dir/DependInfo.cmake"
+  "Day13/CMakeFiles/day_Day13.dir/DependInfo.cmake"
+  "Day13/CMakeFiles/main_Day13.dir/DependInfo.cmake"
+  "Day14/CMakeFiles/day_Day14.dir/DependInfo.cmake"
+  "Day14/CMakeFiles/main_Day14.dir/DependInfo.cmake"
+  "Day15/CMakeFiles/day_Day15.dir/DependInfo.cmake"
+  "Day15/CMakeFiles/main_Day15.dir/DependInfo.cmake"
+  "Day16/CMakeFiles/day_Day16.dir/DependInfo.cmake"
+  "Day16/CMakeFiles/main_Day16.dir/DependInfo.cmake"
+  "Day17/CMakeFiles/day_Day17.dir/DependInfo.cmake"
+  "Day17/CMakeFiles/main_Day17.dir/DependInfo.cmake"
+  "Day18/CMakeFiles/day_Day18.dir/DependInfo.cmake"
+  "Day18/CMakeFiles/main_Day18.dir/DependInfo.cmake"
+  "Day19/CMakeFiles/day_Day19.dir/DependInfo.cmake"
+  "Day19/CMakeFiles/main_Day19.dir/DependInfo.cmake"
+  "Day2/CMakeFiles/day_Day2.dir/DependInfo.cmake"
+  "Day2/CMakeFiles/main_Day2.dir/DependInfo.cmake"
+  "Day20/CMakeFiles/day_Day20.dir/DependInfo.cmake"
+  "Day20/CMakeFiles/main_Day20.dir/DependInfo.cmake"
+  "Day21/CMakeFiles/day_Day21.dir/DependInfo.cmake"
+  "Day21/CMakeFiles/main_Day21.dir/DependInfo.cmake"
+  "Day22/CMakeFiles/day_Day22.dir/DependInfo.cmake"
+  "Day22/CMakeFiles/main_Day22.dir/DependInfo.cmake"
+  "Day23/CMakeFiles/day_Day23.dir/DependInfo.cmake"
+  "Day23/CMakeFiles/main_Day23.dir/DependInfo.cmake"
+  "Day24/CMakeFiles/day_Day24.dir/DependInfo.cmake"
+  "Day24/CMakeFiles/main_Day24.dir/DependInfo.cmake"
+  "Day25/CMakeFiles/day_Day25.dir/DependInfo.cmake"
+  "Day25/CMakeFiles/main_Day25.dir/DependInfo.cmake"
+  "Day3/CMakeFiles/day_Day3.dir/DependInfo.cmake"
+  "Day3/CMakeFiles/main_Day3.dir/DependInfo.cmake"
+  "Day4/CMakeFiles/day_Day4.dir/DependInfo.cmake"
+  "Day4/CMakeFiles/main_Day4.dir/DependInfo.cmake"
+  "Day5/CMakeFiles/day_Day5.dir/DependInfo.cmake"
+  "Day5/CMakeFiles/main_Day5.dir/DependInfo.cmake"
+  "Day6/CMakeFiles/day_Day6.dir/DependInfo.cmake"
+  "Day6/CMakeFiles/main_Day6.dir/DependInfo.cmake"
+  "Day7/CMakeFiles/day_Day7.dir/DependInfo.cmake"
+  "Day7/CMakeFiles/main_Day7.dir/DependInfo.cmake"
+  "Day8/CMakeFiles/day_Day8.dir/DependInfo.cmake"
+  "Day8/CMakeFiles/main_Day8.dir/DependInfo.cmake"
+  "Day9/CMakeFiles/day_Day9.dir/DependInfo.cmake"
+  "Day9/CMakeFiles/main_Day9.dir/DependInfo.cmake"
+  )
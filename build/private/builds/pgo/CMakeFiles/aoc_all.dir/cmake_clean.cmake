@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "aoc_all"
+  "aoc_all.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/aoc_all.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/aoc_runner.dir/aoc21/runner.cpp.o"
+  "CMakeFiles/aoc_runner.dir/aoc21/runner.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/aoc_runner.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/gen_inputs.dir/tools/gen_inputs.cpp.o"
+  "CMakeFiles/gen_inputs.dir/tools/gen_inputs.cpp.o.d"
+  "gen_inputs"
+  "gen_inputs.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/gen_inputs.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
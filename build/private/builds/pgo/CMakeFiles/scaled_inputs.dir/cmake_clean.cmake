@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/scaled_inputs"
+  "scaled_inputs/x10/Day1.txt"
+  "scaled_inputs/x100/Day1.txt"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/scaled_inputs.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
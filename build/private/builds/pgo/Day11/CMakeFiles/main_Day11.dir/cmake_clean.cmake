@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day11"
+  "Day11.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day11.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day14"
+  "Day14.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day14.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
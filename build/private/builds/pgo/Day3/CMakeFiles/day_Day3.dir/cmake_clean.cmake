@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/day_Day3.dir/main.cpp.o"
+  "CMakeFiles/day_Day3.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/day_Day3.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day3"
+  "Day3.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day3.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
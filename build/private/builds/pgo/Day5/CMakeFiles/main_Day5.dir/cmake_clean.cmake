@@ -0,0 +1,9 @@
+file(REMOVE_RECURSE
+  "Day5"
+  "Day5.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/main_Day5.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -1,10 +1,11 @@
 #include "aoc21/helpers.h"
 
-int main(int argc, char** argv) {
+static int run(int argc, char** argv) {
   aoc::AutoTimer t;
 
-  auto f = aoc::open_argv_1(argc, argv);
+  auto f = aoc::map_argv_1(argc, argv);
 
   return 0;
 }
 
+AOC_REGISTER_DAY(0, run);
@@ -0,0 +1,865 @@
+#include "aoc21/helpers.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <random>
+#include <set>
+#include <sys/stat.h>
+
+/*
+ * Writes seeded, valid puzzle inputs for each day, scaled up from the size
+ * of the real inputs, so solvers can be timed against input size:
+ *
+ *   gen_inputs [--seed N] [--scale X] [--out <dir>] [day|first-last ...]
+ *
+ * Files land in <dir>/DayN.txt (default dir: scaled_x<X>), so the directory
+ * can be handed straight to aoc_all --inputs. Lists (Day1 depths, Day4
+ * boards, Day22 cuboids, ...) grow by X; grids (Day9, Day15, Day20, Day25,
+ * ...) grow by X in area. Days whose input is fixed in shape by the puzzle
+ * (Day21 start positions, Day23 burrow, Day24 MONAD) get a fresh random
+ * instance of the same size.
+ *
+ * The same seed and scale always give the same files.
+ */
+
+namespace {
+  // mt19937_64's output is fixed by the standard, the distributions are
+  // not, so ranges are reduced by hand to keep files identical everywhere
+  class Random {
+  private:
+    std::mt19937_64 gen_;
+
+  public:
+    explicit Random(uint64_t seed)
+      : gen_(seed)
+    { }
+
+    // Inclusive on both ends
+    int64_t range(int64_t lo, int64_t hi) {
+      return lo + static_cast<int64_t>(gen_() % static_cast<uint64_t>(hi - lo + 1));
+    }
+
+    bool chance(double p) {
+      return (gen_() >> 11) * (1.0 / 9007199254740992.0) < p;
+    }
+
+    template<typename T>
+    void shuffle(T& v) {
+      for (size_t i = v.size(); i > 1; i--) {
+        std::swap(v[i - 1], v[range(0, i - 1)]);
+      }
+    }
+
+    template<typename T>
+    const auto& pick(const T& v) {
+      return v[range(0, v.size() - 1)];
+    }
+  };
+
+  // Puzzle sized count or side, scaled by factor and never below one
+  size_t scaled(double base, double factor) {
+    return std::max<size_t>(1, static_cast<size_t>(std::llround(base * factor)));
+  }
+
+  void digit_grid(std::ostream& os, Random& rng, size_t width, size_t height, char lo, char hi) {
+    for (size_t y = 0; y < height; y++) {
+      for (size_t x = 0; x < width; x++) {
+        os << static_cast<char>(rng.range(lo, hi));
+      }
+      os << '\n';
+    }
+  }
+
+  void day1(std::ostream& os, Random& rng, double scale) {
+    int64_t depth = rng.range(100, 200);
+    for (size_t i = 0; i < scaled(2000, scale); i++) {
+      depth = std::max<int64_t>(0, depth + rng.range(-6, 10));
+      os << depth << '\n';
+    }
+  }
+
+  void day2(std::ostream& os, Random& rng, double scale) {
+    int64_t aim = 0;
+    for (size_t i = 0; i < scaled(1000, scale); i++) {
+      const int64_t v = rng.range(1, 9);
+      if (rng.chance(0.5)) {
+        os << "forward " << v << '\n';
+      } else if (aim >= v && rng.chance(0.45)) {
+        aim -= v;
+        os << "up " << v << '\n';
+      } else {
+        aim += v;
+        os << "down " << v << '\n';
+      }
+    }
+  }
+
+  // Wider numbers as well as more of them, as the solver drops duplicates
+  void day3(std::ostream& os, Random& rng, double scale) {
+    const size_t bits = std::min<size_t>(30, 12 + static_cast<size_t>(std::max(0.0, std::log2(scale))));
+    for (size_t i = 0; i < scaled(1000, scale); i++) {
+      for (size_t b = 0; b < bits; b++) {
+        os << (rng.chance(0.5) ? '1' : '0');
+      }
+      os << '\n';
+    }
+  }
+
+  // Every number gets drawn, so every board wins eventually
+  void day4(std::ostream& os, Random& rng, double scale) {
+    std::vector<int> numbers(100);
+    for (size_t i = 0; i < numbers.size(); i++) {
+      numbers[i] = static_cast<int>(i);
+    }
+
+    rng.shuffle(numbers);
+    for (size_t i = 0; i < numbers.size(); i++) {
+      os << (i ? "," : "") << numbers[i];
+    }
+    os << '\n';
+
+    for (size_t b = 0; b < scaled(100, scale); b++) {
+      rng.shuffle(numbers);
+      os << '\n';
+      for (size_t r = 0; r < 5; r++) {
+        for (size_t c = 0; c < 5; c++) {
+          os << (c ? " " : "") << std::setw(2) << numbers[r * 5 + c];
+        }
+        os << '\n';
+      }
+    }
+  }
+
+  // Horizontal, vertical and 45 degree lines on a floor that grows with the line count
+  void day5(std::ostream& os, Random& rng, double scale) {
+    const int64_t size = scaled(1000, std::sqrt(scale));
+    for (size_t i = 0; i < scaled(500, scale); i++) {
+      const int64_t x1 = rng.range(0, size - 1);
+      const int64_t y1 = rng.range(0, size - 1);
+      const int64_t len = rng.range(1, size / 2);
+      int64_t dx = 0;
+      int64_t dy = 0;
+      switch (rng.range(0, 2)) {
+        case 0: dx = rng.chance(0.5) ? 1 : -1; break;
+        case 1: dy = rng.chance(0.5) ? 1 : -1; break;
+        default: dx = rng.chance(0.5) ? 1 : -1; dy = rng.chance(0.5) ? 1 : -1; break;
+      }
+      // Shorten to stay on the floor
+      int64_t n = len;
+      while (n > 0 && (x1 + dx * n < 0 || x1 + dx * n >= size || y1 + dy * n < 0 || y1 + dy * n >= size)) {
+        n--;
+      }
+      os << x1 << "," << y1 << " -> " << x1 + dx * n << "," << y1 + dy * n << '\n';
+    }
+  }
+
+  void day6(std::ostream& os, Random& rng, double scale) {
+    for (size_t i = 0; i < scaled(300, scale); i++) {
+      os << (i ? "," : "") << rng.range(1, 5);
+    }
+    os << '\n';
+  }
+
+  // Skewed towards the low end, like the real crabs
+  void day7(std::ostream& os, Random& rng, double scale) {
+    for (size_t i = 0; i < scaled(1000, scale); i++) {
+      os << (i ? "," : "") << rng.range(0, 1999) * rng.range(0, 1999) / 1999;
+    }
+    os << '\n';
+  }
+
+  void day8(std::ostream& os, Random& rng, double scale) {
+    static const std::array<std::string_view, 10> digits = {
+      "abcefg", "cf", "acdeg", "acdfg", "bcdf", "abdfg", "abdefg", "acf", "abcdefg", "abcdfg"
+    };
+
+    std::string wires = "abcdefg";
+    const auto scramble = [&](std::string_view d) {
+      std::string s;
+      for (const char c : d) {
+        s += wires[c - 'a'];
+      }
+      rng.shuffle(s);
+      return s;
+    };
+
+    std::vector<size_t> order(digits.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+
+    for (size_t i = 0; i < scaled(200, scale); i++) {
+      rng.shuffle(wires);
+      rng.shuffle(order);
+      for (const auto d : order) {
+        os << scramble(digits[d]) << ' ';
+      }
+      os << '|';
+      for (size_t j = 0; j < 4; j++) {
+        os << ' ' << scramble(digits[rng.range(0, 9)]);
+      }
+      os << '\n';
+    }
+  }
+
+  // Low ground split into basins by ridges of nines
+  void day9(std::ostream& os, Random& rng, double scale) {
+    const size_t side = scaled(100, std::sqrt(scale));
+    for (size_t y = 0; y < side; y++) {
+      for (size_t x = 0; x < side; x++) {
+        os << static_cast<char>(rng.chance(0.3) ? '9' : rng.range('0', '8'));
+      }
+      os << '\n';
+    }
+  }
+
+  // Every line is either corrupted or incomplete, never closes below an
+  // empty stack, and stays shallow enough for completion scores to fit
+  void day10(std::ostream& os, Random& rng, double scale) {
+    static const std::string_view open = "([{<";
+    static const std::string_view close = ")]}>";
+    constexpr size_t MaxDepth = 20;
+
+    for (size_t i = 0; i < scaled(100, scale); i++) {
+      const size_t len = rng.range(80, 110);
+      const bool corrupt = rng.chance(0.5);
+      std::string line;
+      std::vector<size_t> stack;
+      while (line.size() < len || stack.empty()) {
+        if (!stack.empty() && (stack.size() >= MaxDepth || rng.chance(0.45))) {
+          line += close[stack.back()];
+          stack.pop_back();
+        } else {
+          stack.push_back(rng.range(0, 3));
+          line += open[stack.back()];
+        }
+      }
+
+      if (corrupt) {
+        line += close[(stack.back() + rng.range(1, 3)) % 4];
+      }
+      os << line << '\n';
+    }
+  }
+
+  // Steps until every octopus flashes at once, or 0 if not within limit
+  size_t octopus_sync(std::vector<int> grid, size_t side, size_t limit) {
+    std::vector<size_t> flashing;
+    for (size_t step = 1; step <= limit; step++) {
+      for (size_t i = 0; i < grid.size(); i++) {
+        if (++grid[i] == 10) {
+          flashing.push_back(i);
+        }
+      }
+
+      size_t flashed = 0;
+      while (!flashing.empty()) {
+        const size_t i = flashing.back();
+        flashing.pop_back();
+        flashed++;
+        const size_t x = i % side;
+        const size_t y = i / side;
+        for (size_t ny = y ? y - 1 : y; ny <= std::min(y + 1, side - 1); ny++) {
+          for (size_t nx = x ? x - 1 : x; nx <= std::min(x + 1, side - 1); nx++) {
+            if ((nx != x || ny != y) && ++grid[ny * side + nx] == 10) {
+              flashing.push_back(ny * side + nx);
+            }
+          }
+        }
+      }
+
+      for (auto& v : grid) {
+        v = v > 9 ? 0 : v;
+      }
+      if (flashed == grid.size()) {
+        return step;
+      }
+    }
+    return 0;
+  }
+
+  // The solver runs until all octopuses flash together, which a fully random
+  // grid beyond puzzle size almost never does, so energy levels are drawn
+  // from a narrower band until the grid is seen to synchronize
+  void day11(std::ostream& os, Random& rng, double scale) {
+    const size_t side = scaled(10, std::sqrt(scale));
+    std::vector<int> grid(side * side);
+    for (int width = 10; ; width = std::max(2, width - 1)) {
+      const int base = static_cast<int>(rng.range(0, 10 - width));
+      for (auto& v : grid) {
+        v = base + static_cast<int>(rng.range(0, width - 1));
+      }
+      if (octopus_sync(grid, side, 2000) != 0) {
+        break;
+      }
+    }
+
+    for (size_t y = 0; y < side; y++) {
+      for (size_t x = 0; x < side; x++) {
+        os << static_cast<char>('0' + grid[y * side + x]);
+      }
+      os << '\n';
+    }
+  }
+
+  // Path counts grow exponentially with caves, so one more small cave per
+  // tenfold scale is already a steep climb
+  void day12(std::ostream& os, Random& rng, double scale) {
+    const size_t extra = static_cast<size_t>(std::max(0.0, std::log10(scale)));
+    const size_t smalls = 5 + extra;
+    const size_t bigs = 2 + extra / 3;
+
+    std::set<std::string> used = { "start", "end" };
+    const auto name = [&](bool big) {
+      std::string n;
+      do {
+        n.clear();
+        for (int i = 0; i < 2; i++) {
+          n += static_cast<char>(rng.range(big ? 'A' : 'a', big ? 'Z' : 'z'));
+        }
+      } while (!used.insert(n).second);
+      return n;
+    };
+
+    std::vector<std::string> small;
+    std::vector<std::string> big;
+    for (size_t i = 0; i < smalls; i++) {
+      small.push_back(name(false));
+    }
+    for (size_t i = 0; i < bigs; i++) {
+      big.push_back(name(true));
+    }
+
+    // Two big caves next to each other would allow endless paths
+    std::set<std::pair<std::string, std::string>> edges;
+    const auto connect = [&](const std::string& a, const std::string& b) {
+      if (a != b && !edges.count({ b, a })) {
+        edges.emplace(a, b);
+      }
+    };
+    for (size_t i = 0; i < big.size(); i++) {
+      for (size_t j = 0; j < 3; j++) {
+        connect(big[i], rng.pick(small));
+      }
+    }
+    for (size_t i = 0; i < small.size(); i++) {
+      connect(small[i], rng.chance(0.5) ? rng.pick(small) : rng.pick(big));
+    }
+    connect("start", small[0]);
+    connect("start", big[0]);
+    connect(rng.pick(small), "end");
+    connect(big[0], "end");
+    connect(big.back(), "end");
+
+    std::vector<std::pair<std::string, std::string>> lines(edges.begin(), edges.end());
+    rng.shuffle(lines);
+    for (const auto& [a, b] : lines) {
+      os << a << "-" << b << '\n';
+    }
+  }
+
+  // Folds in half down to a 40x6 sheet, with more folds as the dots grow
+  void day13(std::ostream& os, Random& rng, double scale) {
+    const size_t extra = static_cast<size_t>(std::max(0.0, std::log2(scale) / 2));
+    std::vector<int64_t> fold_x{ 40 };
+    std::vector<int64_t> fold_y{ 6 };
+    for (size_t i = 0; i < 4 + extra; i++) {
+      fold_x.push_back(fold_x.back() * 2 + 1);
+    }
+    for (size_t i = 0; i < 6 + extra; i++) {
+      fold_y.push_back(fold_y.back() * 2 + 1);
+    }
+    const int64_t width = fold_x.back() * 2 + 1;
+    const int64_t height = fold_y.back() * 2 + 1;
+
+    const auto on_fold = [](const std::vector<int64_t>& folds, int64_t v) {
+      return std::find(folds.begin(), folds.end(), v) != folds.end();
+    };
+    std::set<std::pair<int64_t, int64_t>> dots;
+    const size_t count = scaled(866, scale);
+    while (dots.size() < count) {
+      const int64_t x = rng.range(0, width - 1);
+      const int64_t y = rng.range(0, height - 1);
+      if (!on_fold(fold_x, x) && !on_fold(fold_y, y)) {
+        dots.emplace(x, y);
+      }
+    }
+
+    std::vector<std::pair<int64_t, int64_t>> lines(dots.begin(), dots.end());
+    rng.shuffle(lines);
+    for (const auto& [x, y] : lines) {
+      os << x << "," << y << '\n';
+    }
+    os << '\n';
+
+    // Largest first, alternating while both axes have folds left
+    size_t xi = fold_x.size();
+    size_t yi = fold_y.size();
+    while (xi > 0 || yi > 0) {
+      if (xi > 0) {
+        os << "fold along x=" << fold_x[--xi] << '\n';
+      }
+      if (yi > 0) {
+        os << "fold along y=" << fold_y[--yi] << '\n';
+      }
+    }
+  }
+
+  void day14(std::ostream& os, Random& rng, double scale) {
+    std::string letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    rng.shuffle(letters);
+    letters.resize(10);
+
+    for (size_t i = 0; i < scaled(20, scale); i++) {
+      os << rng.pick(letters);
+    }
+    os << "\n\n";
+
+    for (const char a : letters) {
+      for (const char b : letters) {
+        os << a << b << " -> " << rng.pick(letters) << '\n';
+      }
+    }
+  }
+
+  void day15(std::ostream& os, Random& rng, double scale) {
+    const size_t side = scaled(100, std::sqrt(scale));
+    digit_grid(os, rng, side, side, '1', '9');
+  }
+
+  // Packet tree, emitted as a bit string
+  class Transmission {
+  private:
+    Random& rng_;
+
+  public:
+    std::string bits;
+
+    explicit Transmission(Random& rng)
+      : rng_(rng)
+    { }
+
+    void literal(int64_t v) {
+      append(rng_.range(0, 7), 3);
+      append(4, 3);
+      int groups = 1;
+      while (groups < 16 && (v >> (4 * groups)) != 0) {
+        groups++;
+      }
+      for (int g = groups - 1; g >= 0; g--) {
+        append(g ? 1 : 0, 1);
+        append((v >> (4 * g)) & 0xf, 4);
+      }
+    }
+
+    // About budget packets in total, a sum at the top
+    void packet(size_t budget, size_t depth) {
+      if (budget <= 1 || depth >= 12) {
+        literal(rng_.range(0, 4000));
+        return;
+      }
+
+      const int type = depth == 0 ? 0 : static_cast<int>(rng_.pick(std::array<int, 8>{ 0, 0, 1, 2, 3, 5, 6, 7 }));
+      std::vector<std::string> children;
+      Transmission child(rng_);
+      if (type >= 5) {
+        // Comparisons take exactly two
+        for (int i = 0; i < 2; i++) {
+          child.bits.clear();
+          child.packet((budget - 1) / 2, depth + 1);
+          children.push_back(child.bits);
+        }
+      } else if (type == 1) {
+        // Small factors only, so the product stays within 64 bits
+        for (int i = rng_.range(1, 3); i > 0; i--) {
+          child.bits.clear();
+          child.literal(rng_.range(1, 30));
+          children.push_back(child.bits);
+        }
+      } else {
+        size_t left = budget - 1;
+        while (left > 0 && children.size() < 2047) {
+          const size_t share = std::min<size_t>(left, rng_.range(1, std::max<size_t>(1, left / 2)));
+          child.bits.clear();
+          child.packet(share, depth + 1);
+          children.push_back(child.bits);
+          left -= share;
+        }
+      }
+
+      size_t length = 0;
+      for (const auto& c : children) {
+        length += c.size();
+      }
+
+      append(rng_.range(0, 7), 3);
+      append(type, 3);
+      if (length < (1 << 15) && rng_.chance(0.5)) {
+        append(0, 1);
+        append(length, 15);
+      } else {
+        append(1, 1);
+        append(children.size(), 11);
+      }
+      for (const auto& c : children) {
+        bits += c;
+      }
+    }
+
+  private:
+    void append(uint64_t v, int width) {
+      for (int i = width - 1; i >= 0; i--) {
+        bits += ((v >> i) & 1) ? '1' : '0';
+      }
+    }
+  };
+
+  void day16(std::ostream& os, Random& rng, double scale) {
+    Transmission t(rng);
+    t.packet(scaled(180, scale), 0);
+    while (t.bits.size() % 8) {
+      t.bits += '0';
+    }
+
+    static const char hex[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < t.bits.size(); i += 4) {
+      os << hex[std::stoi(t.bits.substr(i, 4), nullptr, 2)];
+    }
+    os << '\n';
+  }
+
+  // The solver's closed form for part 1 wants an even lower y bound, and
+  // the target needs a triangular x for the highest shot to stall over it
+  void day17(std::ostream& os, Random& rng, double scale) {
+    const double f = std::sqrt(scale);
+    int64_t x1 = 0;
+    int64_t x2 = 0;
+    bool triangular = false;
+    while (!triangular) {
+      x1 = rng.range(scaled(100, f), scaled(200, f));
+      x2 = x1 + rng.range(scaled(20, f), scaled(45, f));
+      for (int64_t n = 1; n * (n + 1) / 2 <= x2; n++) {
+        triangular = triangular || n * (n + 1) / 2 >= x1;
+      }
+    }
+
+    const int64_t y1 = -2 * rng.range(scaled(45, f), scaled(70, f));
+    const int64_t y2 = y1 + rng.range(scaled(20, f), scaled(50, f));
+    os << "target area: x=" << x1 << ".." << x2 << ", y=" << y1 << ".." << y2 << '\n';
+  }
+
+  // Already reduced: no pair nested inside four others, every number below 10
+  void snailfish(std::ostream& os, Random& rng, size_t depth) {
+    if (depth > 0 && (depth == 4 || rng.chance(0.35))) {
+      os << rng.range(0, 9);
+      return;
+    }
+    os << '[';
+    snailfish(os, rng, depth + 1);
+    os << ',';
+    snailfish(os, rng, depth + 1);
+    os << ']';
+  }
+
+  void day18(std::ostream& os, Random& rng, double scale) {
+    for (size_t i = 0; i < scaled(100, scale); i++) {
+      snailfish(os, rng, 0);
+      os << '\n';
+    }
+  }
+
+  // Each scanner overlaps one placed before it by at least 12 beacons, is
+  // turned by one of the 24 rotations, and reports what lies within 1000
+  void day19(std::ostream& os, Random& rng, double scale) {
+    using P = std::array<int64_t, 3>;
+    constexpr int64_t Range = 1000;
+
+    std::vector<P> scanners{ { 0, 0, 0 } };
+    std::set<P> beacons;
+    const auto random_in = [&](const P& lo, const P& hi) {
+      return P{ rng.range(lo[0], hi[0]), rng.range(lo[1], hi[1]), rng.range(lo[2], hi[2]) };
+    };
+    const auto cube = [&](const P& s, P& lo, P& hi) {
+      for (int a = 0; a < 3; a++) {
+        lo[a] = s[a] - Range;
+        hi[a] = s[a] + Range;
+      }
+    };
+
+    const size_t count = scaled(31, scale);
+    for (size_t i = 0; i < count; i++) {
+      P lo;
+      P hi;
+      cube(scanners[i], lo, hi);
+      for (int b = 0; b < 6; b++) {
+        beacons.insert(random_in(lo, hi));
+      }
+      if (i + 1 == count) {
+        break;
+      }
+
+      // Keep new scanners at least a cube apart from every other, so beacon
+      // density stays near the real inputs' instead of piling up
+      P s;
+      const P* parent = nullptr;
+      do {
+        parent = &scanners[rng.range(0, i)];
+        for (int a = 0; a < 3; a++) {
+          s[a] = (*parent)[a] + rng.range(-1100, 1100);
+        }
+      } while (std::any_of(scanners.begin(), scanners.end(), [&s](const P& o) {
+        return std::abs(o[0] - s[0]) < Range && std::abs(o[1] - s[1]) < Range && std::abs(o[2] - s[2]) < Range;
+      }));
+      for (int a = 0; a < 3; a++) {
+        lo[a] = std::max((*parent)[a], s[a]) - Range;
+        hi[a] = std::min((*parent)[a], s[a]) + Range;
+      }
+      for (int b = 0; b < 12; b++) {
+        beacons.insert(random_in(lo, hi));
+      }
+      scanners.push_back(s);
+    }
+
+    // Signed axis permutations with determinant +1
+    std::vector<std::pair<std::array<int, 3>, std::array<int, 3>>> rotations;
+    std::array<int, 3> perm = { 0, 1, 2 };
+    do {
+      const int parity = (perm[0] > perm[1]) + (perm[0] > perm[2]) + (perm[1] > perm[2]);
+      for (int signs = 0; signs < 8; signs++) {
+        const std::array<int, 3> sign = { signs & 1 ? -1 : 1, signs & 2 ? -1 : 1, signs & 4 ? -1 : 1 };
+        if ((parity % 2 ? -1 : 1) * sign[0] * sign[1] * sign[2] == 1) {
+          rotations.emplace_back(perm, sign);
+        }
+      }
+    } while (std::next_permutation(perm.begin(), perm.end()));
+
+    for (size_t i = 0; i < scanners.size(); i++) {
+      const auto& s = scanners[i];
+      const auto& [p, sign] = i == 0 ? rotations.front() : rng.pick(rotations);
+      std::vector<P> seen;
+      for (const auto& b : beacons) {
+        if (std::abs(b[0] - s[0]) <= Range && std::abs(b[1] - s[1]) <= Range && std::abs(b[2] - s[2]) <= Range) {
+          const P rel = { b[0] - s[0], b[1] - s[1], b[2] - s[2] };
+          seen.push_back({ sign[0] * rel[p[0]], sign[1] * rel[p[1]], sign[2] * rel[p[2]] });
+        }
+      }
+      rng.shuffle(seen);
+
+      os << (i ? "\n" : "") << "--- scanner " << i << " ---\n";
+      for (const auto& b : seen) {
+        os << b[0] << "," << b[1] << "," << b[2] << '\n';
+      }
+    }
+  }
+
+  // Like the real inputs, the infinite background flips every step
+  void day20(std::ostream& os, Random& rng, double scale) {
+    std::string alg(512, '.');
+    for (auto& c : alg) {
+      c = rng.chance(0.5) ? '#' : '.';
+    }
+    alg.front() = '#';
+    alg.back() = '.';
+    os << alg << "\n\n";
+
+    const size_t side = scaled(100, std::sqrt(scale));
+    for (size_t y = 0; y < side; y++) {
+      for (size_t x = 0; x < side; x++) {
+        os << (rng.chance(0.5) ? '#' : '.');
+      }
+      os << '\n';
+    }
+  }
+
+  // The solver reads one digit, so position 10 is left out
+  void day21(std::ostream& os, Random& rng, double) {
+    os << "Player 1 starting position: " << rng.range(1, 9) << '\n';
+    os << "Player 2 starting position: " << rng.range(1, 9) << '\n';
+  }
+
+  void day22(std::ostream& os, Random& rng, double scale) {
+    // Cuboids outside the initialization area keep clear of it, as in the real inputs
+    const auto cuboid = [&](bool on, int64_t lo, int64_t hi, int64_t min_size, int64_t max_size, bool outside) {
+      std::array<std::pair<int64_t, int64_t>, 3> r;
+      bool clear = false;
+      while (!clear) {
+        for (auto& [start, end] : r) {
+          const int64_t size = rng.range(min_size, max_size);
+          start = rng.range(lo, hi - size);
+          end = start + size;
+          clear = clear || end < -50 || start > 50;
+        }
+        clear = clear || !outside;
+      }
+
+      os << (on ? "on" : "off");
+      for (size_t a = 0; a < 3; a++) {
+        os << (a ? "," : " ") << "xyz"[a] << "=" << r[a].first << ".." << r[a].second;
+      }
+      os << '\n';
+    };
+
+    // Initialization area first, then the reactor at large
+    for (size_t i = 0; i < 20; i++) {
+      cuboid(i < 10 || rng.chance(0.6), -50, 50, 10, 50, false);
+    }
+    for (size_t i = 20; i < scaled(420, scale); i++) {
+      cuboid(rng.chance(0.6), -100000, 100000, 5000, 40000, true);
+    }
+  }
+
+  void day23(std::ostream& os, Random& rng, double) {
+    std::string pods = "AABBCCDD";
+    rng.shuffle(pods);
+    os << "#############\n";
+    os << "#...........#\n";
+    os << "###" << pods[0] << "#" << pods[1] << "#" << pods[2] << "#" << pods[3] << "###\n";
+    os << "  #" << pods[4] << "#" << pods[5] << "#" << pods[6] << "#" << pods[7] << "#\n";
+    os << "  #########\n";
+  }
+
+  // Seven digits push w + b onto a base 26 stack, seven pop it and need
+  // w' = w + b + a, with b + a kept in -8..8 so every pairing can be met
+  void day24(std::ostream& os, Random& rng, double) {
+    std::vector<bool> pushes;
+    size_t depth = 0;
+    size_t left = 7;
+    for (size_t i = 0; i < 14; i++) {
+      const bool push = left > 0 && (depth == 0 || rng.chance(0.5));
+      pushes.push_back(push);
+      depth += push ? 1 : -1;
+      left -= push;
+    }
+
+    std::vector<int64_t> stack_b;
+    for (const bool push : pushes) {
+      int64_t a;
+      int64_t b = rng.range(1, 16);
+      if (push) {
+        a = rng.range(10, 15);
+        stack_b.push_back(b);
+      } else {
+        const int64_t delta = rng.range(-8, 8);
+        a = delta - stack_b.back();
+        stack_b.pop_back();
+      }
+
+      os << "inp w\nmul x 0\nadd x z\nmod x 26\ndiv z " << (push ? 1 : 26) << "\nadd x " << a << '\n';
+      os << "eql x w\neql x 0\nmul y 0\nadd y 25\nmul y x\nadd y 1\nmul z y\nmul y 0\nadd y w\n";
+      os << "add y " << b << "\nmul y x\nadd z y\n";
+    }
+  }
+
+  void day25(std::ostream& os, Random& rng, double scale) {
+    const double f = std::sqrt(scale);
+    const size_t width = scaled(139, f);
+    const size_t height = scaled(137, f);
+    for (size_t y = 0; y < height; y++) {
+      for (size_t x = 0; x < width; x++) {
+        const auto r = rng.range(0, 99);
+        os << (r < 45 ? '.' : r < 73 ? '>' : 'v');
+      }
+      os << '\n';
+    }
+  }
+
+  using Generator = void (*)(std::ostream&, Random&, double);
+  const std::array<Generator, 25> generators = {
+    day1, day2, day3, day4, day5, day6, day7, day8, day9, day10,
+    day11, day12, day13, day14, day15, day16, day17, day18, day19, day20,
+    day21, day22, day23, day24, day25,
+  };
+
+  void usage(const char* name) {
+    std::cerr << "Usage: " << name << " [options] [day|first-last ...]" << std::endl;
+    std::cerr << "  --seed <n>   Random seed (default: 2021)" << std::endl;
+    std::cerr << "  --scale <x>  Size relative to the real puzzle inputs (default: 10)" << std::endl;
+    std::cerr << "  --out <dir>  Where to write DayN.txt (default: scaled_x<scale>)" << std::endl;
+    std::cerr << "With no days given, inputs for every day are written." << std::endl;
+  }
+
+  bool parse_days(std::string_view arg, std::set<int>& days) {
+    if (arg.substr(0, 3) == "Day") {
+      arg.remove_prefix(3);
+    }
+
+    int first = 0;
+    int last = 0;
+    const auto dash = arg.find('-');
+    if (dash == std::string_view::npos) {
+      if (aoc::parse_integer(arg, first) != std::errc()) {
+        return false;
+      }
+      last = first;
+    } else if (aoc::parse_integer(arg.substr(0, dash), first) != std::errc() ||
+        aoc::parse_integer(arg.substr(dash + 1), last) != std::errc()) {
+      return false;
+    }
+
+    for (int d = first; d <= last; d++) {
+      days.insert(d);
+    }
+    return first >= 1 && last <= static_cast<int>(generators.size()) && first <= last;
+  }
+};
+
+int main(int argc, char** argv) {
+  uint64_t seed = 2021;
+  double scale = 10;
+  std::string out;
+  std::set<int> days;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg(argv[i]);
+    if (arg == "--seed" && i + 1 < argc) {
+      if (aoc::parse_integer(argv[++i], seed) != std::errc()) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--scale" && i + 1 < argc) {
+      char* end = nullptr;
+      scale = std::strtod(argv[++i], &end);
+      if (*end != '\0' || !(scale > 0)) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--out" && i + 1 < argc) {
+      out = argv[++i];
+    } else if (!parse_days(arg, days)) {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (out.empty()) {
+    std::ostringstream name;
+    name << "scaled_x" << scale;
+    out = name.str();
+  }
+  if (::mkdir(out.c_str(), 0755) != 0 && errno != EEXIST) {
+    std::cerr << "Cannot create " << out << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  if (days.empty()) {
+    for (int d = 1; d <= static_cast<int>(generators.size()); d++) {
+      days.insert(d);
+    }
+  }
+
+  for (const int day : days) {
+    const std::string path = out + "/Day" + std::to_string(day) + ".txt";
+    std::ofstream f(path);
+    if (!f) {
+      std::cerr << "Cannot write " << path << std::endl;
+      return 1;
+    }
+    // Each day draws from its own stream, so picking days does not change the files
+    Random rng(seed * 1000003 + day);
+    generators[day - 1](f, rng, scale);
+    std::cout << path << std::endl;
+  }
+
+  return 0;
+}